@@ -0,0 +1,125 @@
+﻿/*
+ * 케이스마다 일어나는 힙 할당 수를 세는 벤치마크
+ *
+ * 빌드: cc -O2 -fopenmp -I.. bench_alloc.c \
+ *          $(ls ../[a-z]*.c | grep -v main.c) \
+ *          -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -o bench_alloc
+ *       (GNU ld의 --wrap으로 malloc 계열을 가로챈다)
+ * 실행: ./bench_alloc [케이스 수] [케이스당 최대 job 수]
+ *
+ * main의 solve_test처럼 lane 버퍼 하나에 케이스를 차례로 채우며
+ * SJF, RR, EDF, 우선순위, stride를 돌린다. 같은 케이스들을 두 번 돌려서
+ * 첫 번째 (warm-up)와 두 번째 (steady state)의 할당 수를 따로 보인다
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../sim.h"
+
+static unsigned long long nr_alloc;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nr, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+        nr_alloc++;
+        return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nr, size_t size)
+{
+        nr_alloc++;
+        return __real_calloc(nr, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+        nr_alloc++;
+        return __real_realloc(ptr, size);
+}
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void fill_case(struct job_info *jobs, const int job_cnt,
+                      unsigned int *rnd)
+{
+        sched_time_t t = 0;
+
+        for (int i = 0; i < job_cnt; i++) {
+                t += xorshift(rnd) % 4;
+                jobs[i].arrived = t;
+                jobs[i].amount_time = 1 + xorshift(rnd) % 12;
+                jobs[i].deadline = xorshift(rnd) % 40;
+                jobs[i].prio = xorshift(rnd) % 64;
+                jobs[i].tickets = 1 + xorshift(rnd) % 4;
+                jobs[i].group = 0;
+        }
+}
+
+static unsigned long long run_pass(const int cases, const int max_jobs,
+                                   struct job_info *buf, double *ns)
+{
+        unsigned long long before = nr_alloc;
+        unsigned int rnd = 2463534242U;
+        long long sum = 0;
+        double t0 = now_ns();
+
+        for (int c = 0; c < cases; c++) {
+                struct job_head head = {
+                        .jobs = buf,
+                        .job_cnt = 1 + xorshift(&rnd) % max_jobs,
+                        .bursts = NULL,
+                        .deadline = 1
+                };
+
+                fill_case(buf, head.job_cnt, &rnd);
+                sum += get_sjf_time(&head).tard_time;
+                sum += get_rr_time(&head).tard_time;
+                sum += get_edf_time(&head).tard_time;
+                sum += get_prio_preempt_time(&head).tard_time;
+                sum += get_stride_time(&head).tard_time;
+        }
+
+        *ns = (now_ns() - t0) / cases;
+        if (sum == 42)
+                printf("\n");
+        return nr_alloc - before;
+}
+
+int main(int argc, char *argv[])
+{
+        int cases = argc > 1 ? atoi(argv[1]) : 1000;
+        int max_jobs = argc > 2 ? atoi(argv[2]) : 2000;
+        struct job_info *buf = malloc(max_jobs * sizeof(struct job_info));
+        unsigned long long warm, steady;
+        double warm_ns, steady_ns;
+
+        warm = run_pass(cases, max_jobs, buf, &warm_ns);
+        steady = run_pass(cases, max_jobs, buf, &steady_ns);
+
+        printf("cases %d, max jobs %d\n", cases, max_jobs);
+        printf("warm-up  %10llu allocs  %9.1f ns/case\n", warm, warm_ns);
+        printf("steady   %10llu allocs  %9.1f ns/case\n", steady, steady_ns);
+
+        sim_ctx_free();
+        free(buf);
+        return 0;
+}
@@ -0,0 +1,188 @@
+﻿/*
+ * evq (timing wheel) 와 레드블랙트리 기반 이벤트 큐의 비교
+ *
+ * 빌드: cc -O2 -I.. bench_evq.c ../evq.c ../reloc.c ../rbtree.c -o bench_evq
+ *       (-DCONFIG_EVQ_HEAP를 주면 evq 대신 이진 힙과 비교)
+ * 실행: ./bench_evq [pending 이벤트 수] [hold 연산 수]
+ *
+ * pending 이벤트를 채운 뒤 pop-min 하나에 push 하나를 하는 hold 모델을
+ * 돌리고 마지막에 모두 꺼낸다. 두 큐가 꺼낸 순서의 checksum이
+ * 같아야 결과가 유효하다
+ * 시간은 음수에서 시작해 0을 지나므로 부호가 바뀌는 구간도 확인한다
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../evq.h"
+
+struct rbq_node {
+        struct rb_node                  node;
+        sched_time_t                    when;
+        unsigned int                    seq;
+        void                            *data;
+};
+
+struct rbq {
+        struct rb_root                  root;
+        struct rbq_node                 *nodes;
+        struct rbq_node                 *free;
+        int                             nr;
+        unsigned int                    seq;
+};
+
+static void rbq_push(struct rbq *q, struct rbq_node *new,
+                     const sched_time_t when, void *data)
+{
+        struct rb_node **node = &q->root.rb_node, *parent = NULL;
+
+        new->when = when;
+        new->seq = q->seq++;
+        new->data = data;
+        while (*node) {
+                struct rbq_node *this = container_of(*node, struct rbq_node,
+                                                     node);
+                parent = *node;
+                if (when < this->when)
+                        node = &((*node)->rb_left);
+                else
+                        node = &((*node)->rb_right);
+        }
+
+        rb_link_node(&new->node, parent, node);
+        rb_insert_color(&new->node, &q->root);
+        q->nr++;
+}
+
+static struct rbq_node *rbq_pop(struct rbq *q)
+{
+        struct rbq_node *first = container_of(rb_first(&q->root),
+                                              struct rbq_node, node);
+
+        rb_erase(&first->node, &q->root);
+        q->nr--;
+        return first;
+}
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define WHEN_RANGE      (1 << 20)
+#define WHEN_BASE       (-WHEN_RANGE / 2)
+#define HOLD_RANGE      (1 << 16)
+
+static unsigned long long checksum(unsigned long long sum,
+                                   const sched_time_t when, void *data)
+{
+        return (sum * 31 + (unsigned int)when) * 31 + (size_t)data;
+}
+
+static void bench_evq(const int pending, const int holds)
+{
+        struct evq *q = malloc(sizeof(struct evq));
+        unsigned int rnd = 2463534242U;
+        unsigned long long sum = 0;
+        double t0, t1, t2, t3;
+
+        evq_init(q);
+
+        t0 = now_ns();
+        for (int i = 0; i < pending; i++)
+                evq_push(q, WHEN_BASE + (int)(xorshift(&rnd) % WHEN_RANGE), SIM_EV_TIMER,
+                         (void *)(size_t)i);
+        t1 = now_ns();
+        for (int i = 0; i < holds; i++) {
+                struct sim_event ev = evq_pop(q);
+
+                sum = checksum(sum, ev.when, ev.data);
+                evq_push(q, ev.when + 1 + xorshift(&rnd) % HOLD_RANGE,
+                         SIM_EV_TIMER, ev.data);
+        }
+        t2 = now_ns();
+        while (!evq_empty(q)) {
+                struct sim_event ev = evq_pop(q);
+
+                sum = checksum(sum, ev.when, ev.data);
+        }
+        t3 = now_ns();
+
+        printf("%-8s insert %7.1f ns/op  hold %7.1f ns/op  "
+               "drain %7.1f ns/op  checksum %016llx\n",
+#ifdef CONFIG_EVQ_HEAP
+               "heap",
+#else
+               "wheel",
+#endif
+               (t1 - t0) / pending, (t2 - t1) / holds,
+               (t3 - t2) / pending, sum);
+
+        evq_free(q);
+        free(q);
+}
+
+static void bench_rbq(const int pending, const int holds)
+{
+        struct rbq q = {
+                .root = RB_ROOT,
+                .nr = 0,
+                .seq = 0
+        };
+        unsigned int rnd = 2463534242U;
+        unsigned long long sum = 0;
+        double t0, t1, t2, t3;
+
+        q.nodes = malloc(pending * sizeof(struct rbq_node));
+
+        t0 = now_ns();
+        for (int i = 0; i < pending; i++)
+                rbq_push(&q, q.nodes + i, WHEN_BASE + (int)(xorshift(&rnd) % WHEN_RANGE),
+                         (void *)(size_t)i);
+        t1 = now_ns();
+        for (int i = 0; i < holds; i++) {
+                struct rbq_node *node = rbq_pop(&q);
+
+                sum = checksum(sum, node->when, node->data);
+                rbq_push(&q, node, node->when + 1 + xorshift(&rnd) % HOLD_RANGE,
+                         node->data);
+        }
+        t2 = now_ns();
+        while (q.nr) {
+                struct rbq_node *node = rbq_pop(&q);
+
+                sum = checksum(sum, node->when, node->data);
+        }
+        t3 = now_ns();
+
+        printf("%-8s insert %7.1f ns/op  hold %7.1f ns/op  "
+               "drain %7.1f ns/op  checksum %016llx\n", "rbtree",
+               (t1 - t0) / pending, (t2 - t1) / holds,
+               (t3 - t2) / pending, sum);
+
+        free(q.nodes);
+}
+
+int main(int argc, char *argv[])
+{
+        int pending = argc > 1 ? atoi(argv[1]) : 10000000;
+        int holds = argc > 2 ? atoi(argv[2]) : 10000000;
+
+        printf("pending %d, hold %d\n", pending, holds);
+        bench_evq(pending, holds);
+        bench_rbq(pending, holds);
+
+        return 0;
+}
@@ -0,0 +1,141 @@
+﻿/*
+ * 특수화한 시뮬레이션 루프 (sim_kernel.h)와 엔진의 일반 루프의 비교
+ *
+ * 빌드: cc -O2 -fopenmp -I.. bench_kernel.c \
+ *          $(ls ../[a-z]*.c | grep -v main.c) -o bench_kernel
+ * 실행: ./bench_kernel [job 수] [평균 도착 간격] [job당 평균 수행 시간]
+ *
+ * 같은 SoA job 목록을 정책마다 sim_step (sched_class의 함수 포인터로
+ * 도는 일반 루프)과 sim_run (특수화한 루프로 보냄)으로 돌려
+ * 스케쥴링 결정 하나의 평균 시간을 보인다. 두 결과가 같아야 유효하다
+ * RR은 퀀텀이 NR_RR_QUANTUM인 경우와 그 밖의 퀀텀 (런타임 값)인 경우를
+ * 따로 잰다
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../sim.h"
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int same_info(const struct time_info *a, const struct time_info *b)
+{
+        return a->tard_time == b->tard_time && a->resp_time == b->resp_time &&
+               a->miss_cnt == b->miss_cnt && a->late_time == b->late_time;
+}
+
+/**
+* run_generic - 특수화한 루프를 거치지 않고 일반 루프로 끝까지 수행
+* @class: 정책
+* @head: job 목록
+* @quantum: RR의 퀀텀
+* @nr: 스케쥴링 결정 수를 기록
+*/
+static struct time_info run_generic(const struct sched_class *class,
+                                    const struct job_head *head,
+                                    const sched_time_t quantum, long long *nr)
+{
+        struct sim *sim = malloc(sizeof(struct sim));
+        struct time_info info;
+        int done;
+
+        sim_init(sim, class, head);
+        sim->quantum = quantum;
+        *nr = 0;
+        while ((done = sim_step(sim, 1 << 20)) > 0)
+                *nr += done;
+        info = sim->info;
+        sim_destroy(sim);
+        free(sim);
+        return info;
+}
+
+static struct time_info run_kernel(const struct sched_class *class,
+                                   const struct job_head *head,
+                                   const sched_time_t quantum)
+{
+        struct sim *sim = malloc(sizeof(struct sim));
+        struct time_info info;
+
+        sim_init(sim, class, head);
+        sim->quantum = quantum;
+        sim_run(sim);
+        info = sim->info;
+        sim_destroy(sim);
+        free(sim);
+        return info;
+}
+
+int main(int argc, char *argv[])
+{
+        static const struct {
+                const char                      *name;
+                const struct sched_class        *class;
+                sched_time_t                    quantum;
+        } cases[] = {
+                { "fcfs",       &fcfs_sched_class,      NR_RR_QUANTUM },
+                { "sjf",        &sjf_sched_class,       NR_RR_QUANTUM },
+                { "rr",         &rr_sched_class,        NR_RR_QUANTUM },
+                { "rr q=3",     &rr_sched_class,        3 }
+        };
+        int cnt = argc > 1 ? atoi(argv[1]) : 1000000;
+        int gap = argc > 2 ? atoi(argv[2]) : 10;
+        int mean = argc > 3 ? atoi(argv[3]) : 10;
+        struct job_cols cols;
+        struct job_head head = {
+                .jobs = NULL,
+                .bursts = NULL,
+                .deadline = 0
+        };
+        unsigned int rnd = 2463534242U;
+        sched_time_t t = 0;
+        int bad = 0;
+
+        job_cols_init(&cols);
+        job_cols_reserve(&cols, cnt);
+        for (int i = 0; i < cnt; i++) {
+                t += xorshift(&rnd) % (2 * gap + 1);
+                cols.arrived[i] = t;
+                cols.amount_time[i] = 1 + xorshift(&rnd) % (2 * mean);
+        }
+        head.job_cnt = cnt;
+        head.arrived = cols.arrived;
+        head.amount_time = cols.amount_time;
+
+        printf("jobs %d, gap %d, amount %d\n", cnt, gap, mean);
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+                struct time_info a, b;
+                long long nr;
+                double t0, t1, t2;
+
+                t0 = now_ns();
+                a = run_generic(cases[c].class, &head, cases[c].quantum, &nr);
+                t1 = now_ns();
+                b = run_kernel(cases[c].class, &head, cases[c].quantum);
+                t2 = now_ns();
+
+                printf("%-8s generic %6.1f ns/decision  kernel %6.1f "
+                       "ns/decision  %s\n", cases[c].name, (t1 - t0) / nr,
+                       (t2 - t1) / nr, same_info(&a, &b) ? "ok" : "MISMATCH");
+                bad |= !same_info(&a, &b);
+        }
+
+        job_cols_free(&cols);
+        return bad;
+}
@@ -0,0 +1,261 @@
+﻿/*
+ * rbtree.c와 list.h 기본 연산의 마이크로 벤치마크
+ *
+ * 빌드: cc -O2 -I.. bench_rbtree.c ../rbtree.c ../perf.c -o bench_rbtree
+ * 실행: ./bench_rbtree [최대 노드 수] [최소 노드 수]
+ *
+ * 노드 수를 10^2부터 10배씩 (기본 10^7까지) 늘리며 키 패턴마다
+ * 레드블랙트리의 삽입 (rb_insert_color), 순회 (rb_first/rb_next),
+ * 삽입 순서대로의 삭제 (rb_erase), 정책들이 쓰는 최솟값 꺼내기
+ * (rb_first + rb_erase)와 list의 list_add_tail, list_rotate_left,
+ * list_del을 잰다
+ * 키 패턴은 random, sorted, reverse, dup (키 16개가 반복)이고
+ * random과 dup은 노드를 메모리 순서와 다르게 섞어서 방문한다
+ * 리눅스에서는 perf.h의 카운터로 IPC와 연산당 LLC miss,
+ * branch miss 수도 보인다
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../rbtree.h"
+#include "../list.h"
+#include "../perf.h"
+
+struct bench_node {
+        struct rb_node                  node;
+        struct list_head                list;
+        int                             key;
+};
+
+enum key_pattern {
+        PAT_RANDOM,
+        PAT_SORTED,
+        PAT_REVERSE,
+        PAT_DUP,
+        NR_PATTERNS
+};
+
+static const char *const pattern_name[NR_PATTERNS] = {
+        "random", "sorted", "reverse", "dup"
+};
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* 순회 결과를 여기 모아 컴파일러가 순회를 지우지 못하게 함 */
+static volatile unsigned long long sink;
+
+struct bench_run {
+        double                          t0;
+        int                             n;
+        int                             pat;
+};
+
+static void run_start(struct bench_run *run, const int n, const int pat)
+{
+        run->n = n;
+        run->pat = pat;
+        perf_begin();
+        run->t0 = now_ns();
+}
+
+static void print_per_op(const struct perf_sample *sample, const int counter,
+                         const int n, const char *unit)
+{
+        if (sample->count[counter] >= 0)
+                printf("  %7.2f %s", (double)sample->count[counter] / n, unit);
+        else
+                printf("  %7s %s", "-", unit);
+}
+
+static void run_stop(struct bench_run *run, const char *op,
+                     const unsigned long long check)
+{
+        double ns = (now_ns() - run->t0) / run->n;
+        struct perf_sample sample;
+
+        perf_end(&sample);
+        printf("%9d  %-8s %-16s %8.1f ns/op", run->n, pattern_name[run->pat],
+               op, ns);
+        if (perf_ipc(&sample) >= 0)
+                printf("  %5.2f ipc", perf_ipc(&sample));
+        else
+                printf("  %5s ipc", "-");
+        print_per_op(&sample, PERF_LLC_MISSES, run->n, "llc/op");
+        print_per_op(&sample, PERF_BRANCH_MISSES, run->n, "br/op");
+        printf("\n");
+        sink += check;
+}
+
+static void bench_insert(struct rb_root *root, struct bench_node *new)
+{
+        struct rb_node **node = &root->rb_node, *parent = NULL;
+
+        while (*node) {
+                struct bench_node *this = container_of(*node,
+                                                       struct bench_node,
+                                                       node);
+                parent = *node;
+                if (new->key < this->key)
+                        node = &((*node)->rb_left);
+                else
+                        node = &((*node)->rb_right);
+        }
+
+        rb_link_node(&new->node, parent, node);
+        rb_insert_color(&new->node, root);
+}
+
+/**
+* make_case - 키 패턴에 맞춰 노드의 키와 방문 순서를 정함
+* @nodes: 노드 배열
+* @order: 방문 순서를 기록할 배열
+* @n: 노드 수
+* @pat: 키 패턴
+*/
+static void make_case(struct bench_node *nodes, struct bench_node **order,
+                      const int n, const int pat)
+{
+        unsigned int rnd = 2463534242U;
+
+        for (int i = 0; i < n; i++)
+                order[i] = nodes + i;
+        if (pat == PAT_RANDOM || pat == PAT_DUP) {
+                for (int i = n - 1; i > 0; i--) {
+                        int j = xorshift(&rnd) % (i + 1);
+                        struct bench_node *tmp = order[i];
+
+                        order[i] = order[j];
+                        order[j] = tmp;
+                }
+        }
+
+        for (int i = 0; i < n; i++) {
+                switch (pat) {
+                case PAT_RANDOM:
+                        order[i]->key = (int)(xorshift(&rnd) >> 1);
+                        break;
+                case PAT_SORTED:
+                        order[i]->key = i;
+                        break;
+                case PAT_REVERSE:
+                        order[i]->key = n - i;
+                        break;
+                default:
+                        order[i]->key = xorshift(&rnd) % 16;
+                        break;
+                }
+        }
+}
+
+static void bench_tree(struct bench_node **order, const int n, const int pat)
+{
+        struct rb_root root = RB_ROOT;
+        struct bench_run run;
+        unsigned long long check = 0;
+
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++)
+                bench_insert(&root, order[i]);
+        run_stop(&run, "rb_insert", 0);
+
+        run_start(&run, n, pat);
+        for (struct rb_node *node = rb_first(&root); node;
+             node = rb_next(node)) {
+                struct bench_node *this = container_of(node,
+                                                       struct bench_node,
+                                                       node);
+                check += this->key;
+        }
+        run_stop(&run, "rb_first/next", check);
+
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++)
+                rb_erase(&order[i]->node, &root);
+        run_stop(&run, "rb_erase", 0);
+
+        for (int i = 0; i < n; i++)
+                bench_insert(&root, order[i]);
+        check = 0;
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++) {
+                struct bench_node *first = container_of(rb_first(&root),
+                                                        struct bench_node,
+                                                        node);
+
+                check = check * 31 + first->key;
+                rb_erase(&first->node, &root);
+        }
+        run_stop(&run, "rb_first+erase", check);
+}
+
+static void bench_list(struct bench_node **order, const int n, const int pat)
+{
+        LIST_HEAD(head);
+        struct bench_run run;
+        unsigned long long check = 0;
+
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++)
+                list_add_tail(&order[i]->list, &head);
+        run_stop(&run, "list_add_tail", 0);
+
+        /* RR처럼 맨 앞을 꺼내 맨 뒤로 보냄 */
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++) {
+                struct bench_node *first = container_of(head.next,
+                                                        struct bench_node,
+                                                        list);
+
+                check += first->key;
+                list_rotate_left(&head);
+        }
+        run_stop(&run, "list_rotate_left", check);
+
+        run_start(&run, n, pat);
+        for (int i = 0; i < n; i++)
+                list_del(head.next);
+        run_stop(&run, "list_del", 0);
+}
+
+int main(int argc, char *argv[])
+{
+        int max_n = argc > 1 ? atoi(argv[1]) : 10000000;
+        int min_n = argc > 2 ? atoi(argv[2]) : 100;
+        struct bench_node *nodes = malloc(max_n * sizeof(struct bench_node));
+        struct bench_node **order = malloc(max_n *
+                                           sizeof(struct bench_node *));
+
+        printf("node %d bytes, %d/%d perf counters\n",
+               (int)sizeof(struct bench_node), perf_available(),
+               NR_PERF_COUNTERS);
+
+        for (int n = min_n; n <= max_n; n *= 10) {
+                for (int pat = 0; pat < NR_PATTERNS; pat++) {
+                        make_case(nodes, order, n, pat);
+                        bench_tree(order, n, pat);
+                        bench_list(order, n, pat);
+                }
+                if (n > max_n / 10)
+                        break;
+        }
+
+        free(order);
+        free(nodes);
+        return 0;
+}
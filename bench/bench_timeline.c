@@ -0,0 +1,125 @@
+﻿/*
+ * timeline.c의 기록 비용, 크기, 질의 시간
+ *
+ * 빌드: cc -O2 -fopenmp -I.. bench_timeline.c \
+ *          $(ls ../[a-z]*.c | grep -v main.c) -o bench_timeline
+ * 실행: ./bench_timeline [job 수] [job당 평균 수행 시간]
+ *
+ * SoA job 목록을 RR로 시뮬레이션하면서 timeline을 붙여 구간을 기록한 뒤
+ * 구간당 바이트 수와 두 질의 (시간 t에 수행한 job, job 하나의 수행 기록)의
+ * 평균 시간을 보인다
+ * job마다 수행 기록의 길이 합이 amount time과 같은지, 기록에서 고른 구간의
+ * 시간을 timeline_at으로 되찾을 수 있는지도 확인한다
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../sim.h"
+#include "../timeline.h"
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static double now_ns(void)
+{
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define NR_QUERY        1000000
+#define NR_HIST_QUERY   10000
+
+int main(int argc, char *argv[])
+{
+        int cnt = argc > 1 ? atoi(argv[1]) : 1000000;
+        int mean = argc > 2 ? atoi(argv[2]) : 40;
+        struct job_cols cols;
+        struct job_head head = {
+                .jobs = NULL,
+                .bursts = NULL,
+                .deadline = 0
+        };
+        struct timeline tl;
+        struct sim *sim = malloc(sizeof(struct sim));
+        struct tl_seg *segs, seg;
+        unsigned int rnd = 2463534242U;
+        sched_time_t t = 0, end;
+        long long total = 0, nr, bad = 0;
+        double t0, t1, t2, t3;
+
+        job_cols_init(&cols);
+        job_cols_reserve(&cols, cnt);
+        for (int i = 0; i < cnt; i++) {
+                t += xorshift(&rnd) % mean;
+                cols.arrived[i] = t;
+                cols.amount_time[i] = 1 + xorshift(&rnd) % (2 * mean);
+        }
+        head.job_cnt = cnt;
+        head.arrived = cols.arrived;
+        head.amount_time = cols.amount_time;
+
+        timeline_init(&tl);
+        t0 = now_ns();
+        sim_init(sim, &rr_sched_class, &head);
+        sim->timeline = &tl;
+        sim_run(sim);
+        end = sim->now;
+        sim_destroy(sim);
+        t1 = now_ns();
+
+        nr = timeline_nr(&tl);
+        printf("jobs %d, segments %lld, %.2f bytes/segment, "
+               "simulate %.1f ns/segment\n", cnt, nr,
+               (double)timeline_bytes(&tl) / nr, (t1 - t0) / nr);
+
+        segs = malloc(nr * sizeof(struct tl_seg));
+        for (int i = 0; i < cnt; i++) {
+                long long n = timeline_job(&tl, i, segs, nr);
+                sched_time_t sum = 0;
+
+                for (long long j = 0; j < n; j++)
+                        sum += segs[j].len;
+                if (sum != cols.amount_time[i])
+                        bad++;
+                if (n) {
+                        long long j = xorshift(&rnd) % n;
+                        sched_time_t at = segs[j].start +
+                                          xorshift(&rnd) % segs[j].len;
+
+                        if (!timeline_at(&tl, at, &seg) || seg.idx != i)
+                                bad++;
+                }
+        }
+
+        t2 = now_ns();
+        for (int i = 0; i < NR_QUERY; i++)
+                total += timeline_at(&tl, xorshift(&rnd) % (end + 1), &seg) ?
+                         seg.idx : -1;
+        t3 = now_ns();
+        printf("at      %7.1f ns/query  (checksum %lld)\n",
+               (t3 - t2) / NR_QUERY, total);
+
+        total = 0;
+        t2 = now_ns();
+        for (int i = 0; i < NR_HIST_QUERY; i++)
+                total += timeline_job(&tl, xorshift(&rnd) % cnt, segs, nr);
+        t3 = now_ns();
+        printf("job     %7.1f ns/query  %7.1f ns/segment\n",
+               (t3 - t2) / NR_HIST_QUERY, (t3 - t2) / max(total, 1));
+        printf("%s\n", bad ? "MISMATCH" : "ok");
+
+        free(segs);
+        timeline_free(&tl);
+        job_cols_free(&cols);
+        free(sim);
+        return bad != 0;
+}
@@ -0,0 +1,72 @@
+﻿#include <stdlib.h>
+#include "sched.h"
+
+/**
+* burst_pool_init - 빈 burst 목록을 만듦
+* @pool: burst 목록
+*/
+void burst_pool_init(struct burst_pool *pool)
+{
+        pool->times = NULL;
+        pool->first = malloc(sizeof(int));
+        pool->first[0] = 0;
+        pool->nr = 0;
+        pool->cap = 0;
+        pool->job_cnt = 0;
+        pool->job_cap = 0;
+}
+
+/**
+* burst_pool_free - burst 목록의 메모리를 해제
+* @pool: burst 목록
+*/
+void burst_pool_free(struct burst_pool *pool)
+{
+        free(pool->times);
+        free(pool->first);
+        pool->times = NULL;
+        pool->first = NULL;
+}
+
+/**
+* burst_pool_reset - 메모리는 그대로 두고 burst 목록을 비움
+* @pool: burst 목록
+*
+* 다음 케이스를 읽을 때 배열을 다시 할당하지 않고 재사용한다
+*/
+void burst_pool_reset(struct burst_pool *pool)
+{
+        pool->nr = 0;
+        pool->job_cnt = 0;
+}
+
+/**
+* burst_pool_push - 현재 job에 burst 하나를 덧붙임
+* @pool: burst 목록
+* @time: burst의 길이
+*/
+void burst_pool_push(struct burst_pool *pool, const sched_time_t time)
+{
+        if (pool->nr == pool->cap) {
+                pool->cap = pool->cap ? pool->cap * 2 : 256;
+                pool->times = realloc(pool->times,
+                                      pool->cap * sizeof(sched_time_t));
+        }
+
+        pool->times[pool->nr++] = time;
+}
+
+/**
+* burst_pool_end_job - 현재 job의 burst를 마무리하고 다음 job으로 넘어감
+* @pool: burst 목록
+*/
+void burst_pool_end_job(struct burst_pool *pool)
+{
+        if (pool->job_cnt == pool->job_cap) {
+                pool->job_cap = pool->job_cap ? pool->job_cap * 2 : 64;
+                pool->first = realloc(pool->first,
+                                      (pool->job_cap + 1) * sizeof(int));
+        }
+
+        pool->first[++pool->job_cnt] = pool->nr;
+}
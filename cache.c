@@ -0,0 +1,426 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+#include "sim.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define XXH_PRIME64_1   0x9e3779b185ebca87ULL
+#define XXH_PRIME64_2   0xc2b2ae3d27d4eb4fULL
+#define XXH_PRIME64_3   0x165667b19e3779f9ULL
+#define XXH_PRIME64_4   0x85ebca77c2b2ae63ULL
+#define XXH_PRIME64_5   0x27d4eb2f165667c5ULL
+
+#define CACHE_MAGIC     0x48434f53      /* "SOCH" */
+
+/*
+ * 표나 항목의 배치가 바뀌면 예전 캐시 파일은 버린다
+ * 퀀텀과 정책 상수가 바뀐 것은 cache_params로 알아낸다
+ */
+#define CACHE_VERSION   ((unsigned int)(sizeof(struct cache_table) << 16 | \
+                                        sizeof(struct cache_entry)))
+
+static inline unsigned long long xxh_rotl(const unsigned long long x,
+                                          const int r)
+{
+        return (x << r) | (x >> (64 - r));
+}
+
+static inline unsigned long long xxh_read64(const unsigned char *p)
+{
+        unsigned long long v;
+
+        memcpy(&v, p, sizeof(v));
+        return v;
+}
+
+static inline unsigned int xxh_read32(const unsigned char *p)
+{
+        unsigned int v;
+
+        memcpy(&v, p, sizeof(v));
+        return v;
+}
+
+static inline unsigned long long xxh_round(unsigned long long acc,
+                                           const unsigned long long input)
+{
+        acc += input * XXH_PRIME64_2;
+        acc = xxh_rotl(acc, 31);
+        return acc * XXH_PRIME64_1;
+}
+
+static inline unsigned long long xxh_merge(unsigned long long acc,
+                                           const unsigned long long val)
+{
+        acc ^= xxh_round(0, val);
+        return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/**
+* xxh64 - XXH64 해시를 구함
+* @buf: 해시할 바이트들
+* @len: 바이트 수
+* @seed: 시드
+*
+* little endian 기준으로 참조 구현과 같은 값을 낸다
+*/
+unsigned long long xxh64(const void *buf, const size_t len,
+                         const unsigned long long seed)
+{
+        const unsigned char *p = buf, *end = p + len;
+        unsigned long long h;
+
+        if (len >= 32) {
+                unsigned long long v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+                unsigned long long v2 = seed + XXH_PRIME64_2;
+                unsigned long long v3 = seed;
+                unsigned long long v4 = seed - XXH_PRIME64_1;
+
+                do {
+                        v1 = xxh_round(v1, xxh_read64(p));
+                        v2 = xxh_round(v2, xxh_read64(p + 8));
+                        v3 = xxh_round(v3, xxh_read64(p + 16));
+                        v4 = xxh_round(v4, xxh_read64(p + 24));
+                        p += 32;
+                } while (p + 32 <= end);
+
+                h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) +
+                    xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+                h = xxh_merge(h, v1);
+                h = xxh_merge(h, v2);
+                h = xxh_merge(h, v3);
+                h = xxh_merge(h, v4);
+        } else {
+                h = seed + XXH_PRIME64_5;
+        }
+
+        h += len;
+        for (; p + 8 <= end; p += 8) {
+                h ^= xxh_round(0, xxh_read64(p));
+                h = xxh_rotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        }
+        if (p + 4 <= end) {
+                h ^= xxh_read32(p) * XXH_PRIME64_1;
+                h = xxh_rotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+                p += 4;
+        }
+        for (; p < end; p++) {
+                h ^= *p * XXH_PRIME64_5;
+                h = xxh_rotl(h, 11) * XXH_PRIME64_1;
+        }
+
+        h ^= h >> 33;
+        h *= XXH_PRIME64_2;
+        h ^= h >> 29;
+        h *= XXH_PRIME64_3;
+        h ^= h >> 32;
+        return h;
+}
+
+/**
+* cache_hash - 케이스 하나의 결과를 정하는 입력 전체를 해시
+* @head: job 목록
+*
+* 옵션으로 꺼진 열은 읽을 때 0으로 채워지므로 job_info를 통째로 해시한다
+* SoA 목록은 두 열을 해시하고 나머지 열이 있으면 job_info도 해시한다
+*/
+unsigned long long cache_hash(const struct job_head *head)
+{
+        unsigned long long h = NR_RR_QUANTUM ^ (head->deadline ? ~0ULL : 0);
+        const struct burst_pool *pool = head->bursts;
+
+        if (head->arrived) {
+                h = xxh64(head->arrived, head->job_cnt * sizeof(sched_time_t),
+                          h);
+                h = xxh64(head->amount_time,
+                          head->job_cnt * sizeof(sched_time_t), h);
+        }
+        if (head->jobs)
+                h = xxh64(head->jobs, head->job_cnt * sizeof(struct job_info),
+                          h);
+        if (pool) {
+                h = xxh64(pool->first, (pool->job_cnt + 1) * sizeof(int), h);
+                h = xxh64(pool->times, pool->nr * sizeof(sched_time_t), h);
+        }
+
+        return h;
+}
+
+/*
+ * 정책의 결과를 바꾸는 상수들의 해시
+ * 캐시 파일에 기록해 두고 다르면 파일의 결과를 모두 버린다
+ */
+static unsigned long long cache_params(void)
+{
+        const unsigned long long params[] = {
+                NR_RR_QUANTUM,
+                NR_PRIO,
+                PRIO_AGING_INTERVAL,
+                STRIDE1,
+                LOTTERY_SEED
+        };
+
+        return xxh64(params, sizeof(params), 0);
+}
+
+static inline unsigned long long cache_key(const unsigned long long hash,
+                                           const int policy)
+{
+        return hash ^ (policy * XXH_PRIME64_1);
+}
+
+static void cache_reset(struct cache_table *table)
+{
+        memset(table, 0, sizeof(struct cache_table) +
+               (NR_CACHE_ENTRIES - 1) * sizeof(struct cache_entry));
+        table->magic = CACHE_MAGIC;
+        table->version = CACHE_VERSION;
+        table->cap = NR_CACHE_ENTRIES;
+        table->params = cache_params();
+}
+
+#ifdef _WIN32
+
+static void *cache_map(struct result_cache *cache, const char *path)
+{
+        HANDLE file, map;
+        void *addr = NULL;
+
+        file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+                return NULL;
+
+        map = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0,
+                                 (DWORD)cache->size, NULL);
+        if (map) {
+                addr = MapViewOfFile(map, FILE_MAP_ALL_ACCESS, 0, 0,
+                                     cache->size);
+                CloseHandle(map);
+        }
+        if (addr)
+                cache->file = file;
+        else
+                CloseHandle(file);
+        return addr;
+}
+
+static void cache_unmap(struct result_cache *cache)
+{
+        UnmapViewOfFile(cache->table);
+        CloseHandle(cache->file);
+}
+
+static void cache_lock(struct result_cache *cache, const int excl)
+{
+        OVERLAPPED ov = { 0 };
+
+        if (cache->mapped)
+                LockFileEx(cache->file, excl ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0,
+                           MAXDWORD, MAXDWORD, &ov);
+}
+
+static void cache_unlock(struct result_cache *cache)
+{
+        OVERLAPPED ov = { 0 };
+
+        if (cache->mapped)
+                UnlockFileEx(cache->file, 0, MAXDWORD, MAXDWORD, &ov);
+}
+
+#else
+
+static void *cache_map(struct result_cache *cache, const char *path)
+{
+        struct stat st;
+        void *addr;
+        int fd;
+
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+                return NULL;
+
+        if (fstat(fd, &st) || ((size_t)st.st_size < cache->size &&
+                               ftruncate(fd, cache->size))) {
+                close(fd);
+                return NULL;
+        }
+
+        addr = mmap(NULL, cache->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+        if (addr == MAP_FAILED) {
+                close(fd);
+                return NULL;
+        }
+        cache->file = fd;
+        return addr;
+}
+
+static void cache_unmap(struct result_cache *cache)
+{
+        munmap(cache->table, cache->size);
+        close(cache->file);
+}
+
+/*
+ * flock은 프로세스 사이의 잠금이고, 한 프로세스의 스레드들은
+ * main.c가 critical 구역으로 막는다
+ */
+static void cache_lock(struct result_cache *cache, const int excl)
+{
+        if (cache->mapped)
+                flock(cache->file, excl ? LOCK_EX : LOCK_SH);
+}
+
+static void cache_unlock(struct result_cache *cache)
+{
+        if (cache->mapped)
+                flock(cache->file, LOCK_UN);
+}
+
+#endif
+
+/**
+* cache_open - 결과 캐시를 준비
+* @cache: 결과 캐시
+* @path: 캐시 파일 경로, NULL이면 메모리에만 둠
+*
+* 파일이 없거나 형식이나 정책 상수가 다르면 비운 채로 시작한다
+* 파일을 열 수 없으면 -1을 돌려줌
+*/
+int cache_open(struct result_cache *cache, const char *path)
+{
+        cache->size = sizeof(struct cache_table) +
+                      (NR_CACHE_ENTRIES - 1) * sizeof(struct cache_entry);
+        cache->hits = 0;
+        cache->misses = 0;
+        cache->mapped = path != NULL;
+
+        if (path)
+                cache->table = cache_map(cache, path);
+        else
+                cache->table = malloc(cache->size);
+        if (!cache->table)
+                return -1;
+
+        cache_lock(cache, 1);
+        if (!path || cache->table->magic != CACHE_MAGIC ||
+            cache->table->version != CACHE_VERSION ||
+            cache->table->cap != NR_CACHE_ENTRIES ||
+            cache->table->params != cache_params())
+                cache_reset(cache->table);
+        cache_unlock(cache);
+        return 0;
+}
+
+/**
+* cache_close - 결과 캐시를 닫음
+* @cache: 결과 캐시
+*
+* 파일에 mmap한 캐시의 내용은 파일에 남는다
+*/
+void cache_close(struct result_cache *cache)
+{
+        if (!cache->table)
+                return;
+
+        if (cache->mapped)
+                cache_unmap(cache);
+        else
+                free(cache->table);
+        cache->table = NULL;
+}
+
+static inline int cache_match(const struct cache_entry *entry,
+                              const unsigned long long key,
+                              const struct job_head *head, const int policy)
+{
+        return entry->key == key && entry->policy == policy &&
+               entry->job_cnt == head->job_cnt;
+}
+
+/**
+* cache_lookup - 캐시에서 결과를 찾음
+* @cache: 결과 캐시
+* @hash: cache_hash로 구한 케이스의 해시
+* @head: job 목록
+* @policy: 정책 번호 (enum cache_policy)
+* @info: 찾은 결과를 기록
+*
+* 찾으면 1, 없으면 0을 돌려줌
+*/
+int cache_lookup(struct result_cache *cache, const unsigned long long hash,
+                 const struct job_head *head, const int policy,
+                 struct time_info *info)
+{
+        const unsigned long long key = cache_key(hash, policy);
+        struct cache_table *table = cache->table;
+        int hit = 0;
+
+        cache_lock(cache, 0);
+        for (int i = 0; i < NR_CACHE_PROBE; i++) {
+                struct cache_entry *entry = table->entries +
+                        ((key + i) & (table->cap - 1));
+
+                if (!entry->policy)
+                        break;
+                if (cache_match(entry, key, head, policy)) {
+                        *info = entry->info;
+                        hit = 1;
+                        break;
+                }
+        }
+        cache_unlock(cache);
+
+        if (hit)
+                cache->hits++;
+        else
+                cache->misses++;
+        return hit;
+}
+
+/**
+* cache_insert - 결과를 캐시에 넣음
+* @cache: 결과 캐시
+* @hash: cache_hash로 구한 케이스의 해시
+* @head: job 목록
+* @policy: 정책 번호 (enum cache_policy)
+* @info: 넣을 결과
+*/
+void cache_insert(struct result_cache *cache, const unsigned long long hash,
+                  const struct job_head *head, const int policy,
+                  const struct time_info *info)
+{
+        const unsigned long long key = cache_key(hash, policy);
+        struct cache_table *table = cache->table;
+        struct cache_entry *entry = table->entries + (key & (table->cap - 1));
+
+        cache_lock(cache, 1);
+        for (int i = 0; i < NR_CACHE_PROBE; i++) {
+                struct cache_entry *probe = table->entries +
+                        ((key + i) & (table->cap - 1));
+
+                if (!probe->policy || cache_match(probe, key, head, policy)) {
+                        entry = probe;
+                        break;
+                }
+        }
+
+        if (!entry->policy)
+                table->nr++;
+        entry->key = key;
+        entry->job_cnt = head->job_cnt;
+        entry->policy = policy;
+        entry->info = *info;
+        cache_unlock(cache);
+}
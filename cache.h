@@ -0,0 +1,80 @@
+﻿#ifndef _CACHE_H
+#define _CACHE_H
+
+#include "sched.h"
+
+/*
+ * 같은 job 목록을 다시 시뮬레이션하지 않도록 결과를 기억하는 캐시
+ *
+ * 키는 job 목록 (burst 목록 포함)과 퀀텀, deadline 여부를 xxHash64로
+ * 해시한 값에 정책 번호를 섞은 것이고, 값은 그 정책의 time_info이다
+ * 항목들은 고정 크기의 open addressing 표 하나에 들어 있어서
+ * 메모리에 두거나 파일에 그대로 mmap해 실행 사이에 이어 쓸 수 있다
+ * 자리가 없으면 가장 먼저 찾아본 칸을 덮어쓴다
+ * 파일은 여러 프로세스가 함께 쓸 수 있도록 찾을 때는 공유, 넣을 때는
+ * 배타 잠금을 건다
+ */
+enum cache_policy {
+        CACHE_SJF = 1,
+        CACHE_RR,
+        CACHE_EDF,
+        CACHE_PRIO,
+        CACHE_PRIO_PREEMPT,
+        CACHE_STRIDE,
+        CACHE_LOTTERY
+};
+
+struct cache_entry {
+        unsigned long long              key;
+        int                             job_cnt;
+        int                             policy;
+        struct time_info                info;
+};
+
+/*
+ * @params: 결과를 바꾸는 정책 상수들 (aging 간격, STRIDE1, ...)의 해시
+ */
+struct cache_table {
+        unsigned int                    magic;
+        unsigned int                    version;
+        unsigned int                    cap;
+        unsigned int                    nr;
+        unsigned long long              params;
+        struct cache_entry              entries[1];
+};
+
+/*
+ * @file: 잠금에 쓰는 캐시 파일 (mmap하지 않았으면 쓰지 않음)
+ */
+struct result_cache {
+        struct cache_table              *table;
+        size_t                          size;
+        int                             mapped;
+#ifdef _WIN32
+        void                            *file;
+#else
+        int                             file;
+#endif
+        unsigned long long              hits;
+        unsigned long long              misses;
+};
+
+#define NR_CACHE_ENTRIES        (1 << 16)
+#define NR_CACHE_PROBE          8
+
+extern unsigned long long xxh64(const void *buf, const size_t len,
+                                const unsigned long long seed);
+extern unsigned long long cache_hash(const struct job_head *head);
+
+extern int cache_open(struct result_cache *cache, const char *path);
+extern void cache_close(struct result_cache *cache);
+extern int cache_lookup(struct result_cache *cache,
+                        const unsigned long long hash,
+                        const struct job_head *head, const int policy,
+                        struct time_info *info);
+extern void cache_insert(struct result_cache *cache,
+                         const unsigned long long hash,
+                         const struct job_head *head, const int policy,
+                         const struct time_info *info);
+
+#endif
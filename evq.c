@@ -0,0 +1,484 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "evq.h"
+
+static inline int evq_before(const struct sim_event *a,
+                             const struct sim_event *b)
+{
+        if (a->when != b->when)
+                return a->when < b->when;
+        return (int)(a->seq - b->seq) < 0;
+}
+
+#ifdef CONFIG_EVQ_HEAP
+
+/**
+* evq_init - 빈 이벤트 큐를 만듦
+* @q: 이벤트 큐
+*/
+void evq_init(struct evq *q)
+{
+        q->heap = NULL;
+        q->nr = 0;
+        q->cap = 0;
+        q->seq = 0;
+}
+
+/**
+* evq_free - 이벤트 큐의 메모리를 해제
+* @q: 이벤트 큐
+*/
+void evq_free(struct evq *q)
+{
+        free(q->heap);
+        evq_init(q);
+}
+
+/**
+* evq_push - 이벤트를 큐에 넣음
+* @q: 이벤트 큐
+* @when: 이벤트가 일어날 시간
+* @type: 이벤트 종류
+* @data: 이벤트에 딸린 데이터
+*/
+void evq_push(struct evq *q, const sched_time_t when, const int type,
+              void *data)
+{
+        struct sim_event ev = {
+                .when = when,
+                .seq = q->seq++,
+                .type = type,
+                .data = data
+        };
+        int i;
+
+        if (q->nr == q->cap) {
+                q->cap = q->cap ? q->cap * 2 : 64;
+                q->heap = realloc(q->heap, q->cap * sizeof(struct sim_event));
+        }
+
+        for (i = q->nr++; i > 0; i = (i - 1) / 2) {
+                struct sim_event *parent = q->heap + (i - 1) / 2;
+
+                if (!evq_before(&ev, parent))
+                        break;
+                q->heap[i] = *parent;
+        }
+        q->heap[i] = ev;
+}
+
+/**
+* evq_pop - 가장 빠른 이벤트를 큐에서 꺼냄
+* @q: 비어 있지 않은 이벤트 큐
+*/
+struct sim_event evq_pop(struct evq *q)
+{
+        struct sim_event top = q->heap[0];
+        struct sim_event last = q->heap[--q->nr];
+        int i = 0;
+
+        for (;;) {
+                int child = 2 * i + 1;
+
+                if (child >= q->nr)
+                        break;
+                if (child + 1 < q->nr &&
+                    evq_before(q->heap + child + 1, q->heap + child))
+                        child++;
+                if (!evq_before(q->heap + child, &last))
+                        break;
+                q->heap[i] = q->heap[child];
+                i = child;
+        }
+        q->heap[i] = last;
+
+        return top;
+}
+
+/*
+ * 힙 배열은 크기가 케이스마다 달라 재사용하지 않는다
+ */
+void evq_adopt(struct evq *q, struct evq_slab **spare)
+{
+}
+
+void evq_release(struct evq *q, struct evq_slab **spare)
+{
+        evq_free(q);
+}
+
+/**
+* evq_clone - 이벤트 큐를 복사
+* @dst: 새 이벤트 큐
+* @src: 복사할 이벤트 큐
+* @r: 복사한 구간을 넣을 주소 표
+*
+* 이벤트의 data는 evq_reloc에서 고친다
+*/
+void evq_clone(struct evq *dst, const struct evq *src, struct reloc *r)
+{
+        *dst = *src;
+        dst->heap = NULL;
+        if (src->cap) {
+                dst->heap = malloc(src->cap * sizeof(struct sim_event));
+                memcpy(dst->heap, src->heap,
+                       src->nr * sizeof(struct sim_event));
+        }
+}
+
+/**
+* evq_reloc - 복사된 이벤트 큐의 포인터들을 새 주소로 고침
+* @q: evq_clone으로 만든 이벤트 큐
+* @r: 주소 표
+*/
+void evq_reloc(struct evq *q, struct reloc *r)
+{
+        for (int i = 0; i < q->nr; i++)
+                q->heap[i].data = reloc_ptr(r, q->heap[i].data);
+}
+
+#else
+
+#define NR_EVQ_SLAB     1024
+
+struct evq_slab {
+        struct evq_slab                 *next;
+        struct evq_node                 nodes[NR_EVQ_SLAB];
+};
+
+/**
+* evq_ffs - 비트맵에서 @from 이상인 첫 번째 켜진 비트를 찾음
+* @map: 한 단계의 비트맵
+* @from: 찾기 시작할 칸
+*
+* 없으면 -1을 돌려줌
+*/
+static inline int evq_ffs(const unsigned long long *map, int from)
+{
+        for (int w = from / 64; w < EVQ_WHEEL_WORDS; w++) {
+                unsigned long long bits = map[w];
+
+                if (w == from / 64)
+                        bits &= ~0ULL << (from % 64);
+                if (bits)
+                        return w * 64 + find_first_bit64(bits);
+        }
+
+        return -1;
+}
+
+#define EVQ_KEY_BIAS    0x80000000U
+
+/* 시간을 부호 없는 순서로 바꾼 wheel의 key */
+static inline unsigned int evq_key(const sched_time_t when)
+{
+        return (unsigned int)when ^ EVQ_KEY_BIAS;
+}
+
+static inline sched_time_t evq_time(const unsigned int key)
+{
+        return (sched_time_t)(key ^ EVQ_KEY_BIAS);
+}
+
+/*
+ * 칸의 list는 비트가 켜질 때 초기화하므로 evq_init은
+ * 비트맵만 지우면 된다
+ */
+static inline void evq_link(struct evq *q, struct evq_node *node)
+{
+        unsigned int when = evq_key(node->ev.when);
+        unsigned int diff = when ^ q->clk;
+        int level = 0, slot;
+
+        while (level < EVQ_WHEEL_LEVELS - 1 &&
+               diff >> ((level + 1) * EVQ_WHEEL_BITS))
+                level++;
+        slot = (when >> (level * EVQ_WHEEL_BITS)) & EVQ_WHEEL_MASK;
+
+        if (!(q->map[level][slot / 64] & (1ULL << (slot % 64)))) {
+                INIT_LIST_HEAD(&q->slot[level][slot]);
+                q->map[level][slot / 64] |= 1ULL << (slot % 64);
+        }
+        list_add_tail(&node->list, &q->slot[level][slot]);
+}
+
+static inline void evq_clear_slot(struct evq *q, const int level,
+                                  const int slot)
+{
+        q->map[level][slot / 64] &= ~(1ULL << (slot % 64));
+}
+
+/**
+* evq_init - 빈 이벤트 큐를 만듦
+* @q: 이벤트 큐
+*/
+void evq_init(struct evq *q)
+{
+        q->clk = 0;
+        q->nr = 0;
+        q->seq = 0;
+        q->next_valid = 0;
+        INIT_LIST_HEAD(&q->free_list);
+        q->slabs = NULL;
+        q->spare = NULL;
+        memset(q->map, 0, sizeof(q->map));
+}
+
+/**
+* evq_free - 이벤트 큐의 메모리를 해제
+* @q: 이벤트 큐
+*/
+void evq_free(struct evq *q)
+{
+        struct evq_slab *chain[2] = { q->slabs, q->spare };
+
+        for (int i = 0; i < 2; i++) {
+                struct evq_slab *slab = chain[i];
+
+                while (slab) {
+                        struct evq_slab *next = slab->next;
+
+                        free(slab);
+                        slab = next;
+                }
+        }
+        evq_init(q);
+}
+
+/**
+* evq_adopt - 다른 큐가 쓰던 node slab들을 넘겨받음
+* @q: 방금 만든 이벤트 큐
+* @spare: evq_release로 모아 둔 slab 목록, 넘겨준 뒤 비워짐
+*
+* 넘겨받은 slab은 node가 모자랄 때 malloc 대신 하나씩 꺼내 쓴다
+*/
+void evq_adopt(struct evq *q, struct evq_slab **spare)
+{
+        q->spare = *spare;
+        *spare = NULL;
+}
+
+/**
+* evq_release - 이벤트 큐를 비우고 node slab들을 돌려줌
+* @q: 이벤트 큐
+* @spare: slab들을 이어 붙일 목록
+*/
+void evq_release(struct evq *q, struct evq_slab **spare)
+{
+        struct evq_slab *chain[2] = { q->slabs, q->spare };
+
+        for (int i = 0; i < 2; i++) {
+                struct evq_slab *slab = chain[i];
+
+                while (slab) {
+                        struct evq_slab *next = slab->next;
+
+                        slab->next = *spare;
+                        *spare = slab;
+                        slab = next;
+                }
+        }
+        evq_init(q);
+}
+
+/**
+* evq_push - 이벤트를 큐에 넣음
+* @q: 이벤트 큐
+* @when: 이벤트가 일어날 시간 (마지막으로 꺼낸 이벤트의 시간 이상)
+* @type: 이벤트 종류
+* @data: 이벤트에 딸린 데이터
+*/
+void evq_push(struct evq *q, const sched_time_t when, const int type,
+              void *data)
+{
+        struct evq_node *node;
+
+        if (list_empty(&q->free_list)) {
+                struct evq_slab *slab = q->spare;
+
+                if (slab)
+                        q->spare = slab->next;
+                else
+                        slab = malloc(sizeof(struct evq_slab));
+                slab->next = q->slabs;
+                q->slabs = slab;
+                for (int i = 0; i < NR_EVQ_SLAB; i++)
+                        list_add_tail(&slab->nodes[i].list, &q->free_list);
+        }
+
+        node = container_of(q->free_list.next, struct evq_node, list);
+        list_del(&node->list);
+
+        node->ev.when = when;
+        node->ev.seq = q->seq++;
+        node->ev.type = type;
+        node->ev.data = data;
+
+        q->nr++;
+        evq_link(q, node);
+
+        if (q->next_valid && when < q->next_when)
+                q->next_when = when;
+}
+
+/**
+* evq_next - 가장 빠른 이벤트의 시간을 구함
+* @q: 비어 있지 않은 이벤트 큐
+*
+* 0단계에 있으면 칸의 위치가 곧 시간이고, 위 단계에 있으면
+* 다음 칸의 이벤트들 중 최소를 구해 pop 전까지 기억해 둔다
+*/
+sched_time_t evq_next(struct evq *q)
+{
+        int slot;
+
+        if (q->next_valid)
+                return q->next_when;
+
+        slot = evq_ffs(q->map[0], q->clk & EVQ_WHEEL_MASK);
+        if (slot >= 0) {
+                q->next_when = evq_time((q->clk & ~EVQ_WHEEL_MASK) | slot);
+        } else {
+                for (int level = 1; level < EVQ_WHEEL_LEVELS; level++) {
+                        int shift = level * EVQ_WHEEL_BITS;
+                        int from = ((q->clk >> shift) & EVQ_WHEEL_MASK) + 1;
+                        struct list_head *head, *pos;
+                        struct evq_node *node;
+
+                        slot = from < EVQ_WHEEL_SIZE ?
+                                evq_ffs(q->map[level], from) : -1;
+                        if (slot < 0)
+                                continue;
+
+                        head = &q->slot[level][slot];
+                        node = container_of(head->next, struct evq_node, list);
+                        q->next_when = node->ev.when;
+                        list_for_each(pos, head) {
+                                node = container_of(pos, struct evq_node,
+                                                    list);
+                                if (node->ev.when < q->next_when)
+                                        q->next_when = node->ev.when;
+                        }
+                        break;
+                }
+        }
+
+        q->next_valid = 1;
+        return q->next_when;
+}
+
+/**
+* evq_cascade - 위 단계에서 다음으로 빠른 칸을 아래 단계로 내려 보냄
+* @q: 0단계에 남은 이벤트가 없는 이벤트 큐
+*
+* 시계를 그 칸이 맡은 구간의 시작으로 옮기고 칸의 이벤트를
+* 새 시계 기준으로 다시 넣는다
+*/
+static void evq_cascade(struct evq *q)
+{
+        for (int level = 1; level < EVQ_WHEEL_LEVELS; level++) {
+                int shift = level * EVQ_WHEEL_BITS;
+                int from = ((q->clk >> shift) & EVQ_WHEEL_MASK) + 1;
+                struct list_head *pos, *n;
+                LIST_HEAD(moving);
+                unsigned int mask;
+                int slot;
+
+                slot = from < EVQ_WHEEL_SIZE ?
+                        evq_ffs(q->map[level], from) : -1;
+                if (slot < 0)
+                        continue;
+
+                mask = ((1U << EVQ_WHEEL_BITS) - 1) << shift;
+                mask |= (1U << shift) - 1;
+                q->clk = (q->clk & ~mask) | ((unsigned int)slot << shift);
+
+                list_splice(&q->slot[level][slot], &moving);
+                evq_clear_slot(q, level, slot);
+                list_for_each_safe(pos, n, &moving)
+                        evq_link(q, container_of(pos, struct evq_node, list));
+                return;
+        }
+}
+
+/**
+* evq_pop - 가장 빠른 이벤트를 큐에서 꺼냄
+* @q: 비어 있지 않은 이벤트 큐
+*/
+struct sim_event evq_pop(struct evq *q)
+{
+        struct evq_node *node;
+        struct list_head *head;
+        int slot;
+
+        while ((slot = evq_ffs(q->map[0], q->clk & EVQ_WHEEL_MASK)) < 0)
+                evq_cascade(q);
+
+        head = &q->slot[0][slot];
+        node = container_of(head->next, struct evq_node, list);
+        list_del(&node->list);
+        if (list_empty(head))
+                evq_clear_slot(q, 0, slot);
+
+        q->clk = (q->clk & ~EVQ_WHEEL_MASK) | slot;
+        q->nr--;
+        q->next_valid = 0;
+        list_add(&node->list, &q->free_list);
+
+        return node->ev;
+}
+
+
+/**
+* evq_clone - 이벤트 큐를 복사
+* @dst: 새 이벤트 큐
+* @src: 복사할 이벤트 큐
+* @r: 복사한 구간을 넣을 주소 표
+*
+* node slab들을 그대로 복사해 @r에 넣는다. @src 자체의 구간은
+* 부르는 쪽이 넣어야 하고, list와 data는 evq_reloc에서 고친다
+*/
+void evq_clone(struct evq *dst, const struct evq *src, struct reloc *r)
+{
+        struct evq_slab **tail = &dst->slabs;
+
+        *dst = *src;
+        dst->spare = NULL;
+        for (const struct evq_slab *slab = src->slabs; slab;
+             slab = slab->next) {
+                struct evq_slab *copy = malloc(sizeof(struct evq_slab));
+
+                memcpy(copy, slab, sizeof(struct evq_slab));
+                reloc_add(r, slab, sizeof(struct evq_slab), copy);
+                *tail = copy;
+                tail = &copy->next;
+        }
+        *tail = NULL;
+}
+
+/**
+* evq_reloc - 복사된 이벤트 큐의 포인터들을 새 주소로 고침
+* @q: evq_clone으로 만든 이벤트 큐
+* @r: 주소 표
+*
+* 비트가 꺼진 칸의 list는 쓰이지 않으므로 건너뛴다
+*/
+void evq_reloc(struct evq *q, struct reloc *r)
+{
+        reloc_list(r, &q->free_list);
+        for (int level = 0; level < EVQ_WHEEL_LEVELS; level++)
+                for (int slot = 0; slot < EVQ_WHEEL_SIZE; slot++)
+                        if (q->map[level][slot / 64] & (1ULL << (slot % 64)))
+                                reloc_list(r, &q->slot[level][slot]);
+
+        for (struct evq_slab *slab = q->slabs; slab; slab = slab->next) {
+                for (int i = 0; i < NR_EVQ_SLAB; i++) {
+                        struct evq_node *node = slab->nodes + i;
+
+                        reloc_list(r, &node->list);
+                        node->ev.data = reloc_ptr(r, node->ev.data);
+                }
+        }
+}
+
+#endif
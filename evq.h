@@ -0,0 +1,117 @@
+﻿#ifndef _EVQ_H
+#define _EVQ_H
+
+#include "sched.h"
+#include "reloc.h"
+
+/*
+ * 시뮬레이션 엔진이 다루는 이벤트의 종류
+ * arrival은 정렬된 job 목록의 커서로, completion과 quantum expiry는
+ * 현재 수행 중인 job의 수행 시간으로 처리하므로 큐에 들어가지 않는다
+ * 큐에는 I/O 완료와 정책이 직접 등록하는 timer 이벤트만 들어간다
+ */
+enum sim_event_type {
+        SIM_EV_ARRIVAL,
+        SIM_EV_COMPLETION,
+        SIM_EV_QUANTUM,
+        SIM_EV_TIMER,
+        SIM_EV_IO
+};
+
+struct sim_event {
+        sched_time_t                    when;
+        unsigned int                    seq;
+        int                             type;
+        void                            *data;
+};
+
+struct evq_slab;
+
+#ifdef CONFIG_EVQ_HEAP
+
+/*
+ * struct evq - timer 이벤트의 최소 힙
+ * 같은 시간의 이벤트는 seq로 등록 순서를 지킨다
+ */
+struct evq {
+        struct sim_event                *heap;
+        int                             nr;
+        int                             cap;
+        unsigned int                    seq;
+};
+
+/**
+* evq_next - 가장 빠른 이벤트의 시간을 구함
+* @q: 비어 있지 않은 이벤트 큐
+*/
+static inline sched_time_t evq_next(struct evq *q)
+{
+        return q->heap->when;
+}
+
+#else
+
+/*
+ * 계층적 timing wheel
+ * 시간의 부호 비트를 뒤집은 부호 없는 32비트 key로 보고 (음수 시간이
+ * 0보다 앞에 오도록) 8비트씩 4단계로 나눈다. 시계 @clk도 key이다
+ * 이벤트는 현재 시계와 처음 달라지는 바이트의 단계에 들어가고,
+ * 0단계의 칸은 정확히 한 시간만 담는다
+ * 0단계에서 찾지 못하면 위 단계의 다음 칸을 아래로 내려 보내므로
+ * 이벤트 하나는 많아야 3번 옮겨지고 삽입과 pop-min은 amortized O(1)
+ * 같은 칸 안에서는 list의 tail에 붙이므로 같은 시간의 이벤트는
+ * 등록 순서대로 나온다
+ *
+ * 삽입하는 시간은 마지막으로 꺼낸 이벤트의 시간 이상이어야 한다
+ */
+#define EVQ_WHEEL_BITS          8
+#define EVQ_WHEEL_SIZE          (1 << EVQ_WHEEL_BITS)
+#define EVQ_WHEEL_MASK          (EVQ_WHEEL_SIZE - 1)
+#define EVQ_WHEEL_LEVELS        4
+#define EVQ_WHEEL_WORDS         (EVQ_WHEEL_SIZE / 64)
+
+struct evq_node {
+        struct list_head                list;
+        struct sim_event                ev;
+};
+
+struct evq {
+        unsigned int                    clk;
+        int                             nr;
+        unsigned int                    seq;
+        int                             next_valid;
+        sched_time_t                    next_when;
+        struct list_head                free_list;
+        struct evq_slab                 *slabs;
+        struct evq_slab                 *spare;
+        unsigned long long              map[EVQ_WHEEL_LEVELS]
+                                           [EVQ_WHEEL_WORDS];
+        struct list_head                slot[EVQ_WHEEL_LEVELS]
+                                            [EVQ_WHEEL_SIZE];
+};
+
+extern sched_time_t evq_next(struct evq *q);
+
+#endif
+
+extern void evq_init(struct evq *q);
+extern void evq_free(struct evq *q);
+extern void evq_push(struct evq *q, const sched_time_t when, const int type,
+                     void *data);
+extern struct sim_event evq_pop(struct evq *q);
+extern void evq_adopt(struct evq *q, struct evq_slab **spare);
+extern void evq_release(struct evq *q, struct evq_slab **spare);
+extern void evq_clone(struct evq *dst, const struct evq *src,
+                      struct reloc *r);
+extern void evq_reloc(struct evq *q, struct reloc *r);
+
+/**
+* evq_empty - 이벤트 큐가 비었는지 확인
+* @q: 이벤트 큐
+*/
+static inline int evq_empty(const struct evq *q)
+{
+        return q->nr == 0;
+}
+
+#endif
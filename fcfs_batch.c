@@ -0,0 +1,265 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "sched.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || \
+    defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+/**
+* fcfs_batch_load - 여러 케이스의 job 목록을 SoA 배치로 옮김
+* @batch: 채울 배치 (처음에는 0으로 초기화되어 있어야 함)
+* @heads: 케이스들의 job 목록
+* @cnt: 케이스 수 (NR_FCFS_LANES 이하)
+*
+* 배치의 버퍼는 가장 긴 job 목록에 맞춰 늘어나고 다음 load에서 재사용된다
+*/
+void fcfs_batch_load(struct fcfs_batch *batch, const struct job_head *heads,
+                     const int cnt)
+{
+        int max_cnt = 0, rows;
+        size_t size;
+
+        for (int l = 0; l < cnt; l++)
+                max_cnt = max(max_cnt, (heads + l)->job_cnt);
+
+        /* 커널이 첫 행으로 now를 초기화하므로 최소 한 행은 있어야 함 */
+        rows = max(max_cnt, 1);
+        size = (size_t)rows * NR_FCFS_LANES * sizeof(sched_time_t);
+        if (rows > batch->cap) {
+                free(batch->arrived);
+                free(batch->amount_time);
+                batch->arrived = malloc(size);
+                batch->amount_time = malloc(size);
+                batch->cap = rows;
+        }
+
+        memset(batch->arrived, 0, size);
+        memset(batch->amount_time, 0, size);
+        memset(batch->job_cnt, 0, sizeof(batch->job_cnt));
+        batch->max_cnt = max_cnt;
+
+        for (int l = 0; l < cnt; l++) {
+                const struct job_head *head = heads + l;
+
+                batch->job_cnt[l] = head->job_cnt;
+                for (int i = 0; i < batch->job_cnt[l]; i++) {
+                        int pos = i * NR_FCFS_LANES + l;
+
+                        batch->arrived[pos] = job_head_arrived(head, i);
+                        batch->amount_time[pos] = job_head_amount(head, i);
+                }
+        }
+}
+
+/**
+* fcfs_batch_free - 배치의 버퍼를 해제
+* @batch: 해제할 배치
+*/
+void fcfs_batch_free(struct fcfs_batch *batch)
+{
+        free(batch->arrived);
+        free(batch->amount_time);
+        memset(batch, 0, sizeof(*batch));
+}
+
+#if defined(__AVX512F__)
+
+static void fcfs_batch_kernel(const struct fcfs_batch *batch,
+                              struct time_info *info)
+{
+        const __m512i cnt = _mm512_loadu_si512(batch->job_cnt);
+        __m512i now = _mm512_loadu_si512(batch->arrived);
+        __m512i tard = _mm512_setzero_si512();
+        __m512i resp = _mm512_setzero_si512();
+        sched_time_t out_tard[NR_FCFS_LANES], out_resp[NR_FCFS_LANES];
+
+        for (int i = 0; i < batch->max_cnt; i++) {
+                const sched_time_t *arr = batch->arrived + i * NR_FCFS_LANES;
+                const sched_time_t *amt = batch->amount_time +
+                                          i * NR_FCFS_LANES;
+                __m512i a = _mm512_loadu_si512(arr);
+                __m512i p = _mm512_loadu_si512(amt);
+                __mmask16 active = _mm512_cmpgt_epi32_mask(cnt,
+                                                           _mm512_set1_epi32(i));
+                __m512i r;
+
+                now = _mm512_max_epi32(now, a);
+                r = _mm512_sub_epi32(now, a);
+                resp = _mm512_mask_add_epi32(resp, active, resp, r);
+                tard = _mm512_mask_add_epi32(tard, active, tard,
+                                             _mm512_add_epi32(r, p));
+                now = _mm512_add_epi32(now, p);
+        }
+
+        _mm512_storeu_si512(out_tard, tard);
+        _mm512_storeu_si512(out_resp, resp);
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                (info + l)->tard_time = out_tard[l];
+                (info + l)->resp_time = out_resp[l];
+        }
+}
+
+#elif defined(__AVX2__)
+
+static void fcfs_batch_kernel(const struct fcfs_batch *batch,
+                              struct time_info *info)
+{
+        const __m256i cnt = _mm256_loadu_si256((const __m256i *)
+                                               batch->job_cnt);
+        __m256i now = _mm256_loadu_si256((const __m256i *)batch->arrived);
+        __m256i tard = _mm256_setzero_si256();
+        __m256i resp = _mm256_setzero_si256();
+        sched_time_t out_tard[NR_FCFS_LANES], out_resp[NR_FCFS_LANES];
+
+        for (int i = 0; i < batch->max_cnt; i++) {
+                const sched_time_t *arr = batch->arrived + i * NR_FCFS_LANES;
+                const sched_time_t *amt = batch->amount_time +
+                                          i * NR_FCFS_LANES;
+                __m256i a = _mm256_loadu_si256((const __m256i *)arr);
+                __m256i p = _mm256_loadu_si256((const __m256i *)amt);
+                __m256i active = _mm256_cmpgt_epi32(cnt,
+                                                    _mm256_set1_epi32(i));
+                __m256i r;
+
+                now = _mm256_max_epi32(now, a);
+                r = _mm256_and_si256(_mm256_sub_epi32(now, a), active);
+                resp = _mm256_add_epi32(resp, r);
+                tard = _mm256_add_epi32(tard, _mm256_add_epi32(r,
+                                        _mm256_and_si256(p, active)));
+                now = _mm256_add_epi32(now, p);
+        }
+
+        _mm256_storeu_si256((__m256i *)out_tard, tard);
+        _mm256_storeu_si256((__m256i *)out_resp, resp);
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                (info + l)->tard_time = out_tard[l];
+                (info + l)->resp_time = out_resp[l];
+        }
+}
+
+#elif defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+/* SSE4.1 이전에는 부호 있는 32비트 max가 없으므로 비교 후 섞는다 */
+static inline __m128i fcfs_max_epi32(const __m128i a, const __m128i b)
+{
+#if defined(__SSE4_1__) || defined(__AVX__)
+        return _mm_max_epi32(a, b);
+#else
+        __m128i gt = _mm_cmpgt_epi32(a, b);
+
+        return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+#endif
+}
+
+static void fcfs_batch_kernel(const struct fcfs_batch *batch,
+                              struct time_info *info)
+{
+        const __m128i cnt = _mm_loadu_si128((const __m128i *)batch->job_cnt);
+        __m128i now = _mm_loadu_si128((const __m128i *)batch->arrived);
+        __m128i tard = _mm_setzero_si128();
+        __m128i resp = _mm_setzero_si128();
+        sched_time_t out_tard[NR_FCFS_LANES], out_resp[NR_FCFS_LANES];
+
+        for (int i = 0; i < batch->max_cnt; i++) {
+                const sched_time_t *arr = batch->arrived + i * NR_FCFS_LANES;
+                const sched_time_t *amt = batch->amount_time +
+                                          i * NR_FCFS_LANES;
+                __m128i a = _mm_loadu_si128((const __m128i *)arr);
+                __m128i p = _mm_loadu_si128((const __m128i *)amt);
+                __m128i active = _mm_cmpgt_epi32(cnt, _mm_set1_epi32(i));
+                __m128i r;
+
+                now = fcfs_max_epi32(now, a);
+                r = _mm_and_si128(_mm_sub_epi32(now, a), active);
+                resp = _mm_add_epi32(resp, r);
+                tard = _mm_add_epi32(tard, _mm_add_epi32(r,
+                                     _mm_and_si128(p, active)));
+                now = _mm_add_epi32(now, p);
+        }
+
+        _mm_storeu_si128((__m128i *)out_tard, tard);
+        _mm_storeu_si128((__m128i *)out_resp, resp);
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                (info + l)->tard_time = out_tard[l];
+                (info + l)->resp_time = out_resp[l];
+        }
+}
+
+#else
+
+/*
+ * SIMD가 없는 경우에도 lane들의 의존성 사슬이 서로 독립적이므로
+ * 한 루프에서 같이 돌려 명령어 수준 병렬성을 얻는다
+ */
+static void fcfs_batch_kernel(const struct fcfs_batch *batch,
+                              struct time_info *info)
+{
+        sched_time_t now[NR_FCFS_LANES];
+
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                now[l] = batch->arrived[l];
+                (info + l)->tard_time = 0;
+                (info + l)->resp_time = 0;
+        }
+
+        for (int i = 0; i < batch->max_cnt; i++) {
+                const sched_time_t *arr = batch->arrived + i * NR_FCFS_LANES;
+                const sched_time_t *amt = batch->amount_time +
+                                          i * NR_FCFS_LANES;
+
+                for (int l = 0; l < NR_FCFS_LANES; l++) {
+                        sched_time_t r;
+
+                        now[l] = max(now[l], arr[l]);
+                        r = now[l] - arr[l];
+                        now[l] += amt[l];
+                        if (i < batch->job_cnt[l]) {
+                                (info + l)->resp_time += r;
+                                (info + l)->tard_time += r + amt[l];
+                        }
+                }
+        }
+}
+
+#endif
+
+/**
+* get_fcfs_time_batch - 배치의 모든 케이스에 대해 FCFS 시간을 한 번에 구함
+* @batch: fcfs_batch_load로 채운 배치
+* @info: lane 별 결과 (NR_FCFS_LANES개)
+*
+* lane 하나가 케이스 하나를 맡아 get_fcfs_time과 같은 점화식을
+* 벡터 단위로 진행하므로 결과는 get_fcfs_time과 동일하다
+*/
+void get_fcfs_time_batch(const struct fcfs_batch *batch,
+                         struct time_info *info)
+{
+        memset(info, 0, NR_FCFS_LANES * sizeof(struct time_info));
+        fcfs_batch_kernel(batch, info);
+}
+
+/**
+* get_fcfs_times - 여러 케이스의 FCFS 시간을 NR_FCFS_LANES개씩 묶어 구함
+* @heads: 케이스들의 job 목록
+* @cnt: 케이스 수
+* @info: 케이스 별 결과 (cnt개)
+*/
+void get_fcfs_times(const struct job_head *heads, const int cnt,
+                    struct time_info *info)
+{
+        struct fcfs_batch batch = { 0 };
+        struct time_info out[NR_FCFS_LANES];
+
+        for (int base = 0; base < cnt; base += NR_FCFS_LANES) {
+                int n = min(cnt - base, NR_FCFS_LANES);
+
+                fcfs_batch_load(&batch, heads + base, n);
+                get_fcfs_time_batch(&batch, out);
+                memcpy(info + base, out, n * sizeof(struct time_info));
+        }
+
+        fcfs_batch_free(&batch);
+}
@@ -0,0 +1,144 @@
+﻿#include <stdlib.h>
+#include "sched.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+
+/*
+ * struct fcfs_chunk - job 목록 한 구간의 FCFS 요약
+ *
+ * 구간에 들어올 때의 시간이 t이면 구간이 끝나는 시간은
+ * max(t + shift, done)이다. shift는 구간 amount time의 합,
+ * done은 구간을 첫 job의 arrival time부터 혼자 수행했을 때 끝나는 시간
+ * 이 함수들은 (max, +) 위에서 결합 법칙을 만족하므로 구간별로
+ * 따로 구한 뒤 차례로 합성하면 각 구간의 시작 시간을 얻는다
+ */
+struct fcfs_chunk {
+        sched_time_t                    shift;
+        sched_time_t                    done;
+        sched_time_t                    start;
+        struct time_info                info;
+};
+
+/**
+* fcfs_chunk_summary - 구간의 요약 (shift, done)을 구함
+* @chunk: 결과를 기록할 구간
+* @head: job 목록
+* @from: 구간의 첫 job
+* @to: 구간의 마지막 job 다음
+*/
+static void fcfs_chunk_summary(struct fcfs_chunk *chunk,
+                               const struct job_head *head, const int from,
+                               const int to)
+{
+        sched_time_t now = job_head_arrived(head, from), shift = 0;
+
+        for (int i = from; i < to; i++) {
+                sched_time_t amount_time = job_head_amount(head, i);
+
+                now = max(now, job_head_arrived(head, i)) + amount_time;
+                shift += amount_time;
+        }
+
+        chunk->shift = shift;
+        chunk->done = now;
+}
+
+/**
+* fcfs_chunk_fixup - 확정된 시작 시간으로 구간을 다시 수행하며 시간을 누적
+* @chunk: 시작 시간이 정해진 구간
+* @head: job 목록
+* @from: 구간의 첫 job
+* @to: 구간의 마지막 job 다음
+*/
+static void fcfs_chunk_fixup(struct fcfs_chunk *chunk,
+                             const struct job_head *head, const int from,
+                             const int to)
+{
+        struct time_info info = {
+                .tard_time = 0,
+                .resp_time = 0
+        };
+        sched_time_t now = chunk->start;
+
+        for (int i = from; i < to; i++) {
+                sched_time_t arrived = job_head_arrived(head, i);
+
+                if (arrived > now)
+                        now = arrived;
+                now += sched_job(&info, now, arrived,
+                                 job_head_amount(head, i));
+        }
+
+        chunk->info = info;
+}
+
+#endif
+
+/**
+* get_fcfs_time_par - 여러 스레드로 First Come First Served 스케쥴링의
+*                     총 turnaround time과 총 response time을 구함
+* @head: job 목록
+* @nr_threads: 사용할 스레드 수 (0 이하이면 가능한 최대)
+*
+* job 목록을 스레드 수만큼 나눠 각 구간의 요약을 구하고,
+* 요약을 차례로 합성해 구간의 시작 시간을 정한 뒤
+* 각 구간을 다시 수행하며 시간을 누적해 합친다
+* OpenMP 없이 빌드되었거나 job이 적거나 I/O burst가 있으면
+* get_fcfs_time으로 처리
+*/
+struct time_info get_fcfs_time_par(const struct job_head *head,
+                                   const int nr_threads)
+{
+#ifdef _OPENMP
+        const int jcnt = head->job_cnt;
+        struct time_info info = {
+                .tard_time = 0,
+                .resp_time = 0
+        };
+        struct fcfs_chunk *chunks;
+        int nr_chunks, threads;
+
+        threads = nr_threads > 0 ? nr_threads : omp_get_max_threads();
+        threads = min(threads, jcnt / NR_FCFS_PAR_MIN);
+        if (threads < 2 || head->bursts)
+                return get_fcfs_time(head);
+
+        chunks = malloc(threads * sizeof(struct fcfs_chunk));
+        nr_chunks = threads;
+
+#pragma omp parallel num_threads(threads)
+        {
+                const int nt = omp_get_num_threads();
+                const int tid = omp_get_thread_num();
+                const int from = (int)((long long)jcnt * tid / nt);
+                const int to = (int)((long long)jcnt * (tid + 1) / nt);
+
+                fcfs_chunk_summary(chunks + tid, head, from, to);
+#pragma omp barrier
+#pragma omp single
+                {
+                        sched_time_t now = job_head_arrived(head, 0);
+
+                        nr_chunks = nt;
+                        for (int c = 0; c < nt; c++) {
+                                (chunks + c)->start = now;
+                                now = max(now + (chunks + c)->shift,
+                                          (chunks + c)->done);
+                        }
+                }
+                fcfs_chunk_fixup(chunks + tid, head, from, to);
+        }
+
+        for (int c = 0; c < nr_chunks; c++) {
+                info.tard_time += (chunks + c)->info.tard_time;
+                info.resp_time += (chunks + c)->info.resp_time;
+        }
+
+        free(chunks);
+        return info;
+#else
+        (void)nr_threads;
+        return get_fcfs_time(head);
+#endif
+}
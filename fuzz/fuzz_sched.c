@@ -0,0 +1,1114 @@
+﻿/*
+ * FCFS, SJF, RR 구현들과 엔진의 prio, EDF, stride를 tick 단위 참조
+ * 시뮬레이터와 비교하는 차등 fuzzing
+ *
+ * 빌드 (직접 실행, AFL):
+ *       cc -O1 -g -fsanitize=address -fopenmp -I.. fuzz_sched.c \
+ *          $(ls ../[a-z]*.c | grep -v main.c) -o fuzz_sched
+ *       (AFL은 cc 대신 afl-clang-fast, 실행은 afl-fuzz ... -- ./fuzz_sched @@)
+ * 빌드 (libFuzzer):
+ *       clang -O1 -g -fsanitize=fuzzer,address -DFUZZ_LIBFUZZER -I.. \
+ *          fuzz_sched.c $(ls ../[a-z]*.c | grep -v main.c) -o fuzz_sched
+ * 실행: ./fuzz_sched [입력 파일...]   (파일이 없으면 표준 입력 하나)
+ *       ./fuzz_sched -r [반복 수] [seed]   (무작위 입력을 직접 만듦)
+ *
+ * 입력 바이트를 job 목록으로 풀어 (fuzz_decode) 같은 시간의 도착, 같은
+ * amount time, 긴 빈 시간, INT_MAX 근처나 0을 걸치는 음수 시간을 자주
+ * 만들고, get_fcfs_time/get_sjf_time/get_rr_time과 그 밖의 빠른 경로
+ * (SoA, 병렬/SIMD FCFS, RR 닫힌 식, 특수화한 루프, 조금씩 넣는
+ * sim_feed_cols, 엔진의 일반 루프)의 합계를 참조 시뮬레이터와 비교한다
+ * 엔진으로만 도는 prio, prio-preempt, EDF, stride도 sim_run과 sim_feed로
+ * 수행해 같은 참조 시뮬레이터와 비교한다
+ * 합계는 sched_time_t로 넘칠 수 있으므로 하위 32비트만 비교한다
+ * 또 모든 정책을 수행 중에 sim_fork해 부모와 자식이 각각 fork하지 않은
+ * 수행과 같은 결과로 끝나는지 확인한다 (fuzz_check_fork)
+ *
+ * 다르면 엔진의 일반 루프를 timeline과 함께 다시 돌려 참조 스케쥴과
+ * 처음 달라지는 수행 구간을 보이고, 틀린 구현에는 틀리기 시작하는 가장
+ * 짧은 앞부분 job 목록을 test/testinput.txt 꼴로 보인 뒤 abort한다
+ */
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../sim.h"
+#include "../timeline.h"
+
+/* 참조 시뮬레이터의 SJF 등은 대기 목록을 훑으므로 O(n^2)라 job 수를 제한 */
+#define NR_FUZZ_JOBS            4096
+/* 전체 시간이 이보다 짧으면 빈 tick도 건너뛰지 않고 하나씩 진행 */
+#define FUZZ_TICK_SPAN          (1 << 16)
+/* sim_feed_cols로 한 번에 넣는 job 수 */
+#define NR_FUZZ_FEED            7
+/*
+ * RR은 구현도 참조도 퀀텀 하나마다 결정 하나이므로, 수행 구간이 이보다
+ * 많아지는 퀀텀은 비교하지 않는다 (FCFS와 SJF는 amount time과 상관없음)
+ */
+#define NR_FUZZ_RR_SLICES       (1 << 20)
+/*
+ * stride도 RR처럼 수행 구간 수를 제한하고, 참조 시뮬레이터는 퀀텀마다
+ * 대기 목록을 훑으므로 수행 구간 수와 job 수의 곱도 이만큼으로 제한한다
+ */
+#define NR_FUZZ_SCAN_STEPS      (1LL << 26)
+/* sim_fork는 정책마다 세 번씩 수행하므로 수행 구간이 이만큼일 때까지만 */
+#define NR_FUZZ_FORK_SLICES     (1 << 14)
+
+enum fuzz_policy {
+        FUZZ_FCFS,
+        FUZZ_SJF,
+        FUZZ_RR,
+        FUZZ_PRIO,
+        FUZZ_PRIO_PREEMPT,
+        FUZZ_EDF,
+        FUZZ_STRIDE,
+        NR_FUZZ_POLICY
+};
+
+static const char *const fuzz_policy_name[NR_FUZZ_POLICY] = {
+        "fcfs", "sjf", "rr", "prio", "prio-preempt", "edf", "stride"
+};
+
+static const struct sched_class *const fuzz_class[NR_FUZZ_POLICY] = {
+        &fcfs_sched_class,
+        &sjf_sched_class,
+        &rr_sched_class,
+        &prio_sched_class,
+        &prio_preempt_sched_class,
+        &edf_sched_class,
+        &stride_sched_class
+};
+
+/* 퀀텀마다 결정하는 정책 */
+static inline int fuzz_sliced(const int policy)
+{
+        return policy == FUZZ_RR || policy == FUZZ_STRIDE;
+}
+
+/* job_info의 우선순위, 티켓, deadline을 쓰는 정책 */
+static inline int fuzz_ext(const int policy)
+{
+        return policy >= FUZZ_PRIO;
+}
+
+/*
+ * struct fuzz_case - 풀어낸 job 목록
+ * @jobs와 @cols는 같은 job들의 AoS/SoA 표현
+ * @bursts: sim_fork를 확인할 때 job들을 CPU/I/O burst로 나눈 목록
+ * @quantum: RR을 NR_RR_QUANTUM 말고도 한 번 더 돌릴 퀀텀
+ */
+struct fuzz_case {
+        struct job_info                 jobs[NR_FUZZ_JOBS];
+        struct job_cols                 cols;
+        struct burst_pool               bursts;
+        int                             cnt;
+        sched_time_t                    quantum;
+};
+
+/*
+ * struct ref_result - 참조 시뮬레이터의 결과
+ * @segs: 수행 구간들 (같은 job이 이어서 수행되면 timeline처럼 합침)
+ */
+struct ref_result {
+        long long                       tard_time;
+        long long                       resp_time;
+        struct tl_seg                   *segs;
+        int                             nr_segs;
+        int                             seg_cap;
+};
+
+/*
+ * 한 구현을 부르는 방법
+ * @policy: 비교할 참조 정책
+ * @fixed: 퀀텀을 받지 않아 NR_RR_QUANTUM으로만 도는 구현
+ */
+struct fuzz_engine {
+        const char                      *name;
+        int                             policy;
+        int                             fixed;
+        struct time_info (*run)(const struct fuzz_case *c, const int cnt,
+                                const int policy, const sched_time_t quantum);
+};
+
+static unsigned int fuzz_scale(const unsigned int sel)
+{
+        static const unsigned int scale[4] = { 16, 256, 65536, 1 << 27 };
+
+        return scale[sel & 3];
+}
+
+/**
+* fuzz_decode - 입력 바이트를 job 목록으로 풂
+* @c: job 목록을 기록
+* @data: 입력
+* @size: 입력의 크기
+*
+* 첫 바이트는 퀀텀 (하위 3비트), INT_MAX 쪽으로 미는지 (비트 3),
+* 값의 크기 (비트 4-5), 비트 3이 없을 때 음수 쪽으로 미는지 (비트 6)이고
+* 그 뒤로 job마다 두 바이트 (도착 간격, amount)
+* 음수 쪽으로 밀 때 비트 7이 서 있으면 첫 도착을 SCHED_TIME_MIN + 1에
+* 두고 (sim_feed의 horizon인 다음 도착 - 1이 넘치지 않도록), 아니면
+* 전체 시간의 가운데가 0에 오도록 민다
+* 도착 간격 바이트의 위 2비트가 0이면 앞 job과 같은 시간, 1이면 작은 간격,
+* 2이면 크기에 비례한 간격, 3이면 긴 빈 시간
+* amount 바이트의 맨 위 비트가 서 있으면 앞 job과 같은 amount time
+* 우선순위 (가끔 0-63 밖), 티켓 수 (0이면 1장), 상대 deadline (1/4은
+* 없음)도 두 바이트에서 만든다
+* 모든 job이 끝나는 시간이 SCHED_TIME_MAX를 넘지 않도록 job을 자른다
+*/
+static void fuzz_decode(struct fuzz_case *c, const unsigned char *data,
+                        size_t size)
+{
+        unsigned int flags = size ? data[0] : 0, scale;
+        long long t = 0, span = 0, shift = 0;
+        sched_time_t amount = 1;
+
+        scale = fuzz_scale(flags >> 4);
+        c->quantum = 1 + (flags & 7);
+        c->cnt = 0;
+        for (size_t i = 1; i + 1 < size && c->cnt < NR_FUZZ_JOBS; i += 2) {
+                unsigned int g = data[i], a = data[i + 1];
+                struct job_info *job;
+                long long gap;
+
+                switch (g >> 6) {
+                case 0:
+                        gap = 0;
+                        break;
+                case 1:
+                        gap = g & 0x3f;
+                        break;
+                case 2:
+                        gap = (long long)(g & 0x3f) * scale / 64;
+                        break;
+                default:
+                        gap = (long long)scale * (1 + (g & 0x3f));
+                        break;
+                }
+                if (!(a & 0x80) || !c->cnt)
+                        amount = 1 + (sched_time_t)((long long)(a & 0x7f) *
+                                                    scale / 128);
+                if (!c->cnt)
+                        gap = 0;
+
+                /* 이 job까지 넣어도 끝나는 시간이 넘치지 않아야 한다 */
+                if (max(t + gap, span) + amount > SCHED_TIME_MAX)
+                        break;
+                t += gap;
+                span = max(t, span) + amount;
+                job = c->jobs + c->cnt++;
+                job->arrived = (sched_time_t)t;
+                job->amount_time = amount;
+                job->prio = (g ^ a) & 0x10 ? (int)((g * 7 + a) % 80) - 8 :
+                                             (int)((g ^ a) & 3);
+                job->tickets = (int)((g ^ (a >> 2)) % 6);
+                job->deadline = (g ^ a) & 3 ?
+                                1 + (sched_time_t)((long long)(a & 0x7f) *
+                                                   scale / 32) : 0;
+                job->group = 0;
+        }
+
+        if (flags & 0x8)
+                shift = SCHED_TIME_MAX - span;
+        else if (flags & 0x40)
+                shift = flags & 0x80 ? SCHED_TIME_MIN + 1LL : -(span / 2);
+        job_cols_reserve(&c->cols, max(c->cnt, 1));
+        for (int i = 0; i < c->cnt; i++) {
+                struct job_info *job = c->jobs + i;
+
+                job->arrived += (sched_time_t)shift;
+                c->cols.arrived[i] = job->arrived;
+                c->cols.amount_time[i] = job->amount_time;
+        }
+}
+
+static void ref_add_seg(struct ref_result *r, const int idx,
+                        const long long start, const long long len)
+{
+        if (r->nr_segs) {
+                struct tl_seg *last = r->segs + r->nr_segs - 1;
+
+                if (last->idx == idx && last->start + last->len == start) {
+                        last->len += (sched_time_t)len;
+                        return;
+                }
+        }
+        if (r->nr_segs == r->seg_cap) {
+                r->seg_cap = r->seg_cap ? 2 * r->seg_cap : 256;
+                r->segs = realloc(r->segs, r->seg_cap * sizeof(struct tl_seg));
+        }
+        r->segs[r->nr_segs].idx = idx;
+        r->segs[r->nr_segs].start = (sched_time_t)start;
+        r->segs[r->nr_segs].len = (sched_time_t)len;
+        r->segs[r->nr_segs].back = 0;
+        r->nr_segs++;
+}
+
+/* 참조 시뮬레이터가 아직 우선순위 키를 주지 않은 job */
+#define REF_UNKEYED             LLONG_MIN
+
+/* 음수 시간도 내림으로 나눈 aging epoch */
+static long long ref_epoch(const long long t)
+{
+        long long e = t / PRIO_AGING_INTERVAL;
+
+        return e * PRIO_AGING_INTERVAL > t ? e - 1 : e;
+}
+
+/*
+ * struct ref_queue - 참조 시뮬레이터의 대기 목록
+ * @key: prio는 최고 우선순위가 되는 epoch (지금 epoch + 우선순위),
+ *       EDF는 절대 deadline, stride는 pass
+ * @ord: 같은 키 안의 순서 (맨 앞에 넣으면 음수)
+ */
+struct ref_queue {
+        int                             *queue;
+        long long                       *key;
+        long long                       *ord;
+        int                             head;
+        int                             tail;
+        int                             size;
+        long long                       nr_ord;
+};
+
+static inline int ref_at(const struct ref_queue *q, const int k)
+{
+        return q->queue[k % q->size];
+}
+
+/* @a가 @b보다 먼저 수행되는지 */
+static int ref_before(const struct fuzz_case *c, const struct ref_queue *q,
+                      const long long *rest, const int policy, const int a,
+                      const int b)
+{
+        if (policy == FUZZ_SJF)
+                return rest[a] < rest[b] || (rest[a] == rest[b] && a < b);
+        if (q->key[a] != q->key[b])
+                return q->key[a] < q->key[b];
+        if ((policy == FUZZ_EDF || policy == FUZZ_STRIDE) &&
+            c->jobs[a].arrived != c->jobs[b].arrived)
+                return c->jobs[a].arrived < c->jobs[b].arrived;
+        return q->ord[a] < q->ord[b];
+}
+
+/*
+ * prio는 대기 목록에 들어간 시간의 epoch에 우선순위를 더해 키로 삼는다
+ * 도착한 job은 결정할 때 (CPU가 비거나 수행 구간이 끝날 때) 대기 목록에
+ * 들어가므로 그때 키를 준다
+ */
+static void ref_key_arrivals(const struct fuzz_case *c, struct ref_queue *q,
+                             const int policy, const long long t)
+{
+        if (policy != FUZZ_PRIO && policy != FUZZ_PRIO_PREEMPT)
+                return;
+        for (int k = q->head; k < q->tail; k++) {
+                int i = ref_at(q, k);
+
+                if (q->key[i] == REF_UNKEYED)
+                        q->key[i] = ref_epoch(t) +
+                                    min(max(c->jobs[i].prio, 0), NR_PRIO - 1);
+        }
+}
+
+/*
+ * 수행 구간이 끝난 job을 대기 목록에 돌려 보냄
+ * prio-preempt는 지금 자기 우선순위의 맨 앞에 선다. 우선순위 0에는 나이
+ * 들어 올라온 (키가 지금 epoch보다 작은) job들도 있으므로 그 가운데
+ * 가장 작은 키를 받는다. stride는 stride만큼 pass가 늘어난다
+ */
+static void ref_requeue(const struct fuzz_case *c, struct ref_queue *q,
+                        const int policy, const int curr, const long long t)
+{
+        if (policy == FUZZ_PRIO_PREEMPT) {
+                long long key = ref_epoch(t) +
+                                min(max(c->jobs[curr].prio, 0), NR_PRIO - 1);
+
+                if (key == ref_epoch(t))
+                        for (int k = q->head; k < q->tail; k++)
+                                key = min(key, q->key[ref_at(q, k)]);
+                q->key[curr] = key;
+                q->ord[curr] = -++q->nr_ord;
+        } else {
+                if (policy == FUZZ_STRIDE)
+                        q->key[curr] += STRIDE1 /
+                                        max(c->jobs[curr].tickets, 1);
+                q->ord[curr] = ++q->nr_ord;
+        }
+        q->queue[q->tail++ % q->size] = curr;
+}
+
+/**
+* ref_simulate - tick 단위 참조 시뮬레이터
+* @c: job 목록
+* @cnt: 앞에서부터 쓸 job 수
+* @policy: 정책
+* @quantum: RR과 stride의 퀀텀
+* @r: 결과를 기록
+*
+* 구현들과 코드를 나누지 않고 정의대로만 돈다
+* tick t가 시작되면 t에 도착한 job을 도착 순서로 큐에 넣고, 수행 중이던
+* job이 끝났으면 기록하고 퀀텀을 다 썼으면 (선점하는 정책은 새 job이
+* 도착했어도) 큐 뒤로 돌려 보낸 뒤, CPU가 비었으면 다음 job을 고르고
+* 한 tick 수행한다
+* FCFS와 RR은 큐의 head를, SJF는 amount time이 가장 짧은 job을 (같으면
+* 먼저 도착한 job) 고른다. prio는 aging한 우선순위, EDF는 절대
+* deadline, stride는 pass가 가장 작은 job을 고르고 (같으면 먼저 도착한,
+* 그다음 큐에 먼저 들어온 job) 시간은 64비트로 센다
+* 전체 시간이 FUZZ_TICK_SPAN보다 길면 아무 일도 없는 tick들 (다음 도착
+* 또는 수행이 끝날 때까지)은 한 번에 건너뛴다
+*/
+static void ref_simulate(const struct fuzz_case *c, const int cnt,
+                         const int policy, const sched_time_t quantum,
+                         struct ref_result *r)
+{
+        struct ref_queue q = {
+                .queue = malloc((cnt + 1) * sizeof(int)),
+                .key = malloc((cnt + 1) * sizeof(long long)),
+                .ord = malloc((cnt + 1) * sizeof(long long)),
+                .head = 0,
+                .tail = 0,
+                .size = cnt + 1,
+                .nr_ord = 0
+        };
+        long long *rest = malloc((cnt + 1) * sizeof(long long));
+        const int preempt = policy == FUZZ_PRIO_PREEMPT || policy == FUZZ_EDF;
+        int next = 0, curr = -1, tick;
+        long long t, slice = 0, span = 0, vtime = 0;
+
+        r->tard_time = 0;
+        r->resp_time = 0;
+        r->nr_segs = 0;
+        if (!cnt)
+                goto out;
+
+        for (int i = 0; i < cnt; i++) {
+                rest[i] = c->jobs[i].amount_time;
+                span = max(span, (long long)c->jobs[i].arrived) + rest[i];
+        }
+        tick = span - c->jobs[0].arrived <= FUZZ_TICK_SPAN;
+
+        for (t = c->jobs[0].arrived;; ) {
+                int pulled = 0;
+                long long step;
+
+                for (; next < cnt && c->jobs[next].arrived <= t; next++) {
+                        const struct job_info *job = c->jobs + next;
+
+                        if (policy == FUZZ_EDF)
+                                q.key[next] = job->deadline ?
+                                        min((long long)job->arrived +
+                                            job->deadline, SCHED_TIME_MAX) :
+                                        SCHED_TIME_MAX;
+                        else if (policy == FUZZ_STRIDE)
+                                q.key[next] = vtime;
+                        else
+                                q.key[next] = REF_UNKEYED;
+                        q.ord[next] = ++q.nr_ord;
+                        q.queue[q.tail++ % q.size] = next;
+                        pulled = 1;
+                }
+
+                if (curr >= 0 && !rest[curr]) {
+                        r->tard_time += t - c->jobs[curr].arrived;
+                        curr = -1;
+                } else if (curr >= 0 && (!slice || (preempt && pulled))) {
+                        ref_key_arrivals(c, &q, policy, t);
+                        ref_requeue(c, &q, policy, curr, t);
+                        curr = -1;
+                }
+
+                if (curr < 0) {
+                        int pos = q.head;
+
+                        if (q.head == q.tail) {
+                                if (next == cnt)
+                                        break;
+                                if (tick)
+                                        t++;
+                                else
+                                        t = c->jobs[next].arrived;
+                                continue;
+                        }
+                        ref_key_arrivals(c, &q, policy, t);
+                        if (policy != FUZZ_FCFS && policy != FUZZ_RR)
+                                for (int k = q.head + 1; k < q.tail; k++)
+                                        if (ref_before(c, &q, rest, policy,
+                                                       ref_at(&q, k),
+                                                       ref_at(&q, pos)))
+                                                pos = k;
+                        /* FCFS와 RR 말고는 키로 정하므로 큐의 순서는 상관없다 */
+                        curr = ref_at(&q, pos);
+                        q.queue[pos % q.size] = ref_at(&q, q.head);
+                        q.head++;
+                        if (policy == FUZZ_STRIDE)
+                                vtime = q.key[curr];
+                        if (rest[curr] == c->jobs[curr].amount_time)
+                                r->resp_time += t - c->jobs[curr].arrived;
+                        slice = fuzz_sliced(policy) ?
+                                min(rest[curr], quantum) : rest[curr];
+                }
+
+                step = 1;
+                if (!tick) {
+                        step = slice;
+                        if (next < cnt)
+                                step = min(step, c->jobs[next].arrived - t);
+                }
+                ref_add_seg(r, curr, t, step);
+                rest[curr] -= step;
+                slice -= step;
+                t += step;
+        }
+
+out:
+        free(q.queue);
+        free(q.key);
+        free(q.ord);
+        free(rest);
+}
+
+static struct time_info run_get_time(const struct fuzz_case *c, const int cnt,
+                                     const int policy,
+                                     const sched_time_t quantum)
+{
+        struct job_head head = {
+                .jobs = (struct job_info *)c->jobs,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = NULL,
+                .amount_time = NULL
+        };
+
+        if (policy == FUZZ_FCFS)
+                return get_fcfs_time(&head);
+        if (policy == FUZZ_SJF)
+                return get_sjf_time(&head);
+        return get_rr_time(&head);
+}
+
+static struct time_info run_get_time_soa(const struct fuzz_case *c,
+                                         const int cnt, const int policy,
+                                         const sched_time_t quantum)
+{
+        struct job_head head = {
+                .jobs = NULL,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = c->cols.arrived,
+                .amount_time = c->cols.amount_time
+        };
+
+        if (policy == FUZZ_FCFS)
+                return get_fcfs_time(&head);
+        if (policy == FUZZ_SJF)
+                return get_sjf_time(&head);
+        return get_rr_time(&head);
+}
+
+static struct time_info run_fcfs_par(const struct fuzz_case *c, const int cnt,
+                                     const int policy,
+                                     const sched_time_t quantum)
+{
+        struct job_head head = {
+                .jobs = NULL,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = c->cols.arrived,
+                .amount_time = c->cols.amount_time
+        };
+
+        return get_fcfs_time_par(&head, 0);
+}
+
+/*
+ * SIMD 배치는 lane마다 앞부분의 길이를 달리해 넣고 lane 0 (전체)의
+ * 결과를 돌려준다. 나머지 lane은 fuzz_check_lanes가 확인한다
+ */
+static struct time_info run_fcfs_lanes(const struct fuzz_case *c,
+                                       const int cnt, const int policy,
+                                       const sched_time_t quantum)
+{
+        struct job_head heads[NR_FCFS_LANES];
+        struct time_info info[NR_FCFS_LANES];
+
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                heads[l].jobs = NULL;
+                heads[l].job_cnt = cnt - cnt * l / NR_FCFS_LANES;
+                heads[l].bursts = NULL;
+                heads[l].deadline = 0;
+                heads[l].arrived = c->cols.arrived;
+                heads[l].amount_time = c->cols.amount_time;
+        }
+        get_fcfs_times(heads, NR_FCFS_LANES, info);
+        return info[0];
+}
+
+/**
+* run_sim - 엔진으로 수행
+* @c: job 목록
+* @cnt: 쓸 job 수
+* @policy: 정책
+* @quantum: RR과 stride의 퀀텀
+* @tl: NULL이 아니면 붙여서 수행 구간을 기록 (일반 루프로 돎)
+*
+* @tl이 없으면 sim_run이 특수화한 루프를 고른다
+* 우선순위, 티켓, deadline은 job_info에만 있으므로 그것을 쓰는 정책은
+* 열과 함께 job_info도 넘긴다
+*/
+static struct time_info run_sim_tl(const struct fuzz_case *c, const int cnt,
+                                   const int policy, const sched_time_t quantum,
+                                   struct timeline *tl)
+{
+        struct job_head head = {
+                .jobs = fuzz_ext(policy) ? (struct job_info *)c->jobs : NULL,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = c->cols.arrived,
+                .amount_time = c->cols.amount_time
+        };
+        struct sim *sim = malloc(sizeof(struct sim));
+        struct time_info info;
+
+        sim_init(sim, fuzz_class[policy], &head);
+        sim->quantum = quantum;
+        sim->timeline = tl;
+        sim_run(sim);
+        info = sim->info;
+        sim_destroy(sim);
+        free(sim);
+        return info;
+}
+
+static struct time_info run_sim(const struct fuzz_case *c, const int cnt,
+                                const int policy, const sched_time_t quantum)
+{
+        return run_sim_tl(c, cnt, policy, quantum, NULL);
+}
+
+static struct time_info run_sim_generic(const struct fuzz_case *c,
+                                        const int cnt, const int policy,
+                                        const sched_time_t quantum)
+{
+        struct timeline tl;
+        struct time_info info;
+
+        timeline_init(&tl);
+        info = run_sim_tl(c, cnt, policy, quantum, &tl);
+        timeline_free(&tl);
+        return info;
+}
+
+/*
+ * serve와 ooc처럼 NR_FUZZ_FEED개씩 넣으며 horizon까지 진행
+ * job_info를 쓰는 정책은 sim_feed로 넣는다
+ */
+static struct time_info run_sim_feed(const struct fuzz_case *c, const int cnt,
+                                     const int policy,
+                                     const sched_time_t quantum)
+{
+        struct sim *sim = malloc(sizeof(struct sim));
+        struct time_info info;
+
+        sim_open(sim, fuzz_class[policy]);
+        sim->quantum = quantum;
+        for (int i = 0; i < cnt; i += NR_FUZZ_FEED) {
+                int n = min(NR_FUZZ_FEED, cnt - i);
+                sched_time_t horizon = i + n < cnt ?
+                                       c->cols.arrived[i + n] - 1 :
+                                       c->cols.arrived[cnt - 1];
+
+                if (fuzz_ext(policy))
+                        sim_feed(sim, c->jobs + i, n, horizon);
+                else
+                        sim_feed_cols(sim, c->cols.arrived + i,
+                                      c->cols.amount_time + i, n, horizon);
+                sim_run_until(sim, horizon);
+        }
+        sim_close(sim);
+        sim_run(sim);
+        info = sim->info;
+        sim_destroy(sim);
+        free(sim);
+        return info;
+}
+
+static const struct fuzz_engine fuzz_engines[] = {
+        { "get_fcfs_time",      FUZZ_FCFS, 1, run_get_time },
+        { "get_fcfs_time soa",  FUZZ_FCFS, 1, run_get_time_soa },
+        { "get_fcfs_time_par",  FUZZ_FCFS, 1, run_fcfs_par },
+        { "get_fcfs_times",     FUZZ_FCFS, 1, run_fcfs_lanes },
+        { "sim_run fcfs",       FUZZ_FCFS, 1, run_sim },
+        { "sim_feed_cols fcfs", FUZZ_FCFS, 1, run_sim_feed },
+        { "get_sjf_time",       FUZZ_SJF,  1, run_get_time },
+        { "get_sjf_time soa",   FUZZ_SJF,  1, run_get_time_soa },
+        { "sim_run sjf",        FUZZ_SJF,  1, run_sim },
+        { "sim_feed_cols sjf",  FUZZ_SJF,  1, run_sim_feed },
+        { "get_rr_time",        FUZZ_RR,   1, run_get_time },
+        { "get_rr_time soa",    FUZZ_RR,   1, run_get_time_soa },
+        { "sim_run rr",         FUZZ_RR,   0, run_sim },
+        { "sim_feed_cols rr",   FUZZ_RR,   0, run_sim_feed },
+        { "sim engine",         FUZZ_FCFS, 1, run_sim_generic },
+        { "sim engine",         FUZZ_SJF,  1, run_sim_generic },
+        { "sim engine",         FUZZ_RR,   0, run_sim_generic },
+        { "sim_run prio",       FUZZ_PRIO, 1, run_sim },
+        { "sim_feed prio",      FUZZ_PRIO, 1, run_sim_feed },
+        { "sim_run prio-preempt", FUZZ_PRIO_PREEMPT, 1, run_sim },
+        { "sim_feed prio-preempt", FUZZ_PRIO_PREEMPT, 1, run_sim_feed },
+        { "sim_run edf",        FUZZ_EDF,  1, run_sim },
+        { "sim_feed edf",       FUZZ_EDF,  1, run_sim_feed },
+        { "sim_run stride",     FUZZ_STRIDE, 0, run_sim },
+        { "sim_feed stride",    FUZZ_STRIDE, 0, run_sim_feed }
+};
+
+#define NR_FUZZ_ENGINES (sizeof(fuzz_engines) / sizeof(fuzz_engines[0]))
+
+/* 합계는 sched_time_t로 넘칠 수 있으므로 하위 32비트만 비교 */
+static int fuzz_same(const struct time_info *info, const struct ref_result *r)
+{
+        return (unsigned int)info->tard_time == (unsigned int)r->tard_time &&
+               (unsigned int)info->resp_time == (unsigned int)r->resp_time;
+}
+
+static void fuzz_print_seg(const char *what, const struct tl_seg *seg)
+{
+        if (seg)
+                fprintf(stderr, "  %-9s job %d at %d for %d\n", what,
+                        seg->idx, seg->start, seg->len);
+        else
+                fprintf(stderr, "  %-9s (none)\n", what);
+}
+
+/**
+* fuzz_first_step - 엔진의 수행 구간과 참조 스케쥴이 처음 달라지는 곳을 보임
+* @c: job 목록
+* @policy: 정책
+* @quantum: 퀀텀
+* @r: 참조 결과
+*
+* 참조 구간마다 그 시작 시간에 엔진이 수행한 구간을 timeline_at으로 찾아
+* 비교한다. 모두 같으면 구간 수를 비교한다
+*/
+static void fuzz_first_step(const struct fuzz_case *c, const int policy,
+                            const sched_time_t quantum,
+                            const struct ref_result *r)
+{
+        struct timeline tl;
+        struct tl_seg seg;
+        int k;
+
+        timeline_init(&tl);
+        run_sim_tl(c, c->cnt, policy, quantum, &tl);
+
+        for (k = 0; k < r->nr_segs; k++) {
+                int ran = timeline_at(&tl, r->segs[k].start, &seg);
+
+                if (!ran || seg.idx != r->segs[k].idx ||
+                    seg.start != r->segs[k].start ||
+                    seg.len != r->segs[k].len)
+                        break;
+        }
+        if (k < r->nr_segs) {
+                fprintf(stderr, " engine schedule diverges at step %d:\n", k);
+                fuzz_print_seg("reference", r->segs + k);
+                fuzz_print_seg("engine", timeline_at(&tl, r->segs[k].start,
+                                                     &seg) ? &seg : NULL);
+        } else if (timeline_nr(&tl) != r->nr_segs) {
+                fprintf(stderr, " engine ran %lld steps, reference %d\n",
+                        timeline_nr(&tl), r->nr_segs);
+        } else {
+                fprintf(stderr, " engine schedule matches the reference\n");
+        }
+        timeline_free(&tl);
+}
+
+/**
+* fuzz_report - 틀린 구현이 틀리기 시작하는 가장 짧은 앞부분을 찾아 보임
+* @c: job 목록
+* @e: 틀린 구현
+* @quantum: 퀀텀
+* @r: 전체 목록의 참조 결과
+*/
+static void fuzz_report(const struct fuzz_case *c,
+                        const struct fuzz_engine *e,
+                        const sched_time_t quantum, const struct ref_result *r)
+{
+        struct ref_result pr = { 0, 0, NULL, 0, 0 };
+        struct time_info got = e->run(c, c->cnt, e->policy, quantum);
+        int k;
+
+        fprintf(stderr, "%s (%s, quantum %d): %d %d, reference %lld %lld\n",
+                e->name, fuzz_policy_name[e->policy], quantum, got.tard_time,
+                got.resp_time, r->tard_time, r->resp_time);
+        fuzz_first_step(c, e->policy, quantum, r);
+
+        for (k = 1; k < c->cnt; k++) {
+                struct time_info info = e->run(c, k, e->policy, quantum);
+
+                ref_simulate(c, k, e->policy, quantum, &pr);
+                if (!fuzz_same(&info, &pr))
+                        break;
+        }
+        fprintf(stderr, " first diverges with %d jobs; job %d first runs:\n",
+                k, k - 1);
+        ref_simulate(c, k, e->policy, quantum, &pr);
+        for (int i = 0; i < pr.nr_segs; i++)
+                if (pr.segs[i].idx == k - 1) {
+                        fprintf(stderr, "  step %d: job %d at %d for %d\n", i,
+                                k - 1, pr.segs[i].start, pr.segs[i].len);
+                        break;
+                }
+        if (!fuzz_ext(e->policy)) {
+                fprintf(stderr, " input:\n1\n%d\n", k);
+                for (int i = 0; i < k; i++)
+                        fprintf(stderr, "%d %d\n", c->jobs[i].arrived,
+                                c->jobs[i].amount_time);
+        } else {
+                fprintf(stderr, " input (-p -t -d):\n1\n%d\n", k);
+                for (int i = 0; i < k; i++)
+                        fprintf(stderr, "%d %d %d %d %d\n",
+                                c->jobs[i].arrived, c->jobs[i].amount_time,
+                                c->jobs[i].prio, c->jobs[i].tickets,
+                                c->jobs[i].deadline);
+        }
+        free(pr.segs);
+}
+
+static const struct sched_class *const fuzz_fork_class[] = {
+        &fcfs_sched_class,
+        &sjf_sched_class,
+        &rr_sched_class,
+        &edf_sched_class,
+        &prio_sched_class,
+        &prio_preempt_sched_class,
+        &stride_sched_class,
+        &lottery_sched_class,
+        &fair_sched_class
+};
+
+#define NR_FUZZ_FORK_CLASS \
+        (sizeof(fuzz_fork_class) / sizeof(fuzz_fork_class[0]))
+
+static int fuzz_same_info(const struct time_info *a,
+                          const struct time_info *b)
+{
+        return a->tard_time == b->tard_time && a->resp_time == b->resp_time &&
+               a->miss_cnt == b->miss_cnt && a->late_time == b->late_time;
+}
+
+/**
+* fork_run - 결정 @at개를 진행한 뒤 fork해 한쪽을 끝까지 수행
+* @class: 정책
+* @head: job 목록
+* @at: fork하기 전에 진행할 결정 수
+* @child: 0이면 자식을 먼저 끝내고 없앤 뒤 부모를, 1이면 부모를 먼저
+*         없앤 뒤 자식을 끝까지 수행
+* @info: 끝까지 수행한 쪽의 결과를 기록
+*
+* 남은 쪽이 먼저 없앤 쪽의 메모리를 쓰고 있으면 결과가 달라지거나
+* sanitizer가 잡는다
+* fork 연산이 없는 정책이면 -1을 돌려줌
+*/
+static int fork_run(const struct sched_class *class,
+                    const struct job_head *head, const int at,
+                    const int child, struct time_info *info)
+{
+        struct sim *sim = malloc(2 * sizeof(struct sim)), *fork = sim + 1;
+
+        sim_init(sim, class, head);
+        sim_step(sim, at);
+        if (sim_fork(fork, sim)) {
+                sim_destroy(sim);
+                free(sim);
+                return -1;
+        }
+        if (child) {
+                sim_destroy(sim);
+                sim_step(fork, 1);
+                sim_run(fork);
+                *info = fork->info;
+                sim_destroy(fork);
+        } else {
+                sim_run(fork);
+                sim_destroy(fork);
+                sim_run(sim);
+                *info = sim->info;
+                sim_destroy(sim);
+        }
+        free(sim);
+        return 0;
+}
+
+/**
+* fuzz_split_bursts - job들을 CPU/I/O burst로 나눔
+* @c: job 목록 (@c->bursts에 기록)
+*
+* job i는 amount time을 1 + i % 3개 (amount time보다 많지 않게)의
+* CPU burst로 나누고 사이에 짧은 I/O burst를 둔다
+* I/O 시간을 더해 끝나는 시간이 SCHED_TIME_MAX를 넘을 수 있으면 0을 돌려줌
+*/
+static int fuzz_split_bursts(struct fuzz_case *c)
+{
+        long long end = c->jobs[c->cnt - 1].arrived;
+
+        burst_pool_reset(&c->bursts);
+        for (int i = 0; i < c->cnt; i++) {
+                const sched_time_t amount = c->jobs[i].amount_time;
+                const int k = min(1 + i % 3, amount);
+
+                for (int j = 0; j < k; j++) {
+                        sched_time_t io = 1 + (i * 7 + j) % 13;
+
+                        burst_pool_push(&c->bursts, amount / k +
+                                        (j == k - 1 ? amount % k : 0));
+                        if (j == k - 1)
+                                break;
+                        burst_pool_push(&c->bursts, io);
+                        end += io;
+                }
+                burst_pool_end_job(&c->bursts);
+                end += amount;
+        }
+
+        return end <= SCHED_TIME_MAX;
+}
+
+/**
+* fuzz_check_fork - 수행 중에 fork한 엔진이 fork하지 않은 엔진과 같은지 확인
+* @c: job 목록
+*
+* 모든 정책을 burst가 하나인 목록과 I/O burst가 끼인 목록 (이벤트 큐를
+* 씀)으로 수행해 결정을 반쯤 진행한 뒤 fork하고, 부모와 자식이 각각
+* 끝까지 수행한 결과를 fork하지 않은 결과와 비교한다
+* 다르면 1을 돌려줌
+*/
+static int fuzz_check_fork(struct fuzz_case *c)
+{
+        struct job_head head = {
+                .jobs = c->jobs,
+                .job_cnt = c->cnt,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = NULL,
+                .amount_time = NULL
+        };
+        int bad = 0;
+
+        for (int b = 0; b < 2; b++) {
+                if (b && !fuzz_split_bursts(c))
+                        break;
+                head.bursts = b ? &c->bursts : NULL;
+                for (size_t k = 0; k < NR_FUZZ_FORK_CLASS; k++) {
+                        const struct sched_class *class = fuzz_fork_class[k];
+                        struct time_info want, got;
+
+                        want = sim_simulate(class, &head);
+                        for (int child = 0; child < 2; child++) {
+                                if (fork_run(class, &head, c->cnt, child,
+                                             &got)) {
+                                        fprintf(stderr, "sim_fork (%s): "
+                                                "no fork operation\n",
+                                                class->name);
+                                        bad = 1;
+                                        continue;
+                                }
+                                if (fuzz_same_info(&got, &want))
+                                        continue;
+                                fprintf(stderr, "sim_fork %s (%s%s, %d jobs): "
+                                        "%d %d, unforked %d %d\n",
+                                        child ? "child" : "parent",
+                                        class->name, b ? ", bursts" : "",
+                                        c->cnt, got.tard_time, got.resp_time,
+                                        want.tard_time, want.resp_time);
+                                bad = 1;
+                        }
+                }
+        }
+
+        return bad;
+}
+
+/* SIMD 배치의 나머지 lane (앞부분 목록)을 확인. 다르면 1을 돌려줌 */
+static int fuzz_check_lanes(const struct fuzz_case *c)
+{
+        struct job_head heads[NR_FCFS_LANES];
+        struct time_info info[NR_FCFS_LANES];
+        struct ref_result lr = { 0, 0, NULL, 0, 0 };
+        int bad = 0;
+
+        for (int l = 0; l < NR_FCFS_LANES; l++) {
+                heads[l].jobs = NULL;
+                heads[l].job_cnt = c->cnt - c->cnt * l / NR_FCFS_LANES;
+                heads[l].bursts = NULL;
+                heads[l].deadline = 0;
+                heads[l].arrived = c->cols.arrived;
+                heads[l].amount_time = c->cols.amount_time;
+        }
+        get_fcfs_times(heads, NR_FCFS_LANES, info);
+        for (int l = 1; l < NR_FCFS_LANES; l++) {
+                ref_simulate(c, heads[l].job_cnt, FUZZ_FCFS, 0, &lr);
+                if (fuzz_same(info + l, &lr))
+                        continue;
+                fprintf(stderr, "get_fcfs_times lane %d (%d jobs): "
+                        "%d %d, reference %lld %lld\n", l, heads[l].job_cnt,
+                        info[l].tard_time, info[l].resp_time, lr.tard_time,
+                        lr.resp_time);
+                bad = 1;
+        }
+        free(lr.segs);
+        return bad;
+}
+
+/**
+* fuzz_check - job 목록 하나로 모든 구현을 참조와 비교
+* @c: job 목록
+*
+* 틀린 구현이 있으면 보고한 뒤 abort (fuzzer가 입력을 저장하도록)
+*/
+static void fuzz_check(struct fuzz_case *c)
+{
+        struct ref_result r[NR_FUZZ_POLICY][2];
+        const sched_time_t quanta[2] = { NR_RR_QUANTUM, c->quantum };
+        long long slices[2] = { 0, 0 };
+        int rr_ok[2], stride_ok[2], bad = 0;
+
+        if (!c->cnt)
+                return;
+
+        for (int q = 0; q < 2; q++) {
+                for (int i = 0; i < c->cnt; i++)
+                        slices[q] += (c->jobs[i].amount_time + quanta[q] - 1) /
+                                     quanta[q];
+                rr_ok[q] = slices[q] <= NR_FUZZ_RR_SLICES;
+                stride_ok[q] = rr_ok[q] &&
+                               slices[q] * c->cnt <= NR_FUZZ_SCAN_STEPS;
+        }
+
+        for (int p = 0; p < NR_FUZZ_POLICY; p++)
+                for (int q = 0; q < 2; q++) {
+                        r[p][q].segs = NULL;
+                        r[p][q].seg_cap = 0;
+                        r[p][q].nr_segs = 0;
+                        if ((q && !fuzz_sliced(p)) ||
+                            (p == FUZZ_RR && !rr_ok[q]) ||
+                            (p == FUZZ_STRIDE && !stride_ok[q]))
+                                continue;
+                        ref_simulate(c, c->cnt, p, quanta[q], &r[p][q]);
+                }
+
+        for (size_t i = 0; i < NR_FUZZ_ENGINES; i++) {
+                const struct fuzz_engine *e = fuzz_engines + i;
+
+                for (int q = 0; q < (e->fixed ? 1 : 2); q++) {
+                        struct time_info info;
+
+                        if ((e->policy == FUZZ_RR && !rr_ok[q]) ||
+                            (e->policy == FUZZ_STRIDE && !stride_ok[q]))
+                                continue;
+                        info = e->run(c, c->cnt, e->policy, quanta[q]);
+                        if (fuzz_same(&info, &r[e->policy][q]))
+                                continue;
+                        fuzz_report(c, e, quanta[q], &r[e->policy][q]);
+                        bad = 1;
+                }
+        }
+
+        if (fuzz_check_lanes(c))
+                bad = 1;
+
+        if (slices[0] <= NR_FUZZ_FORK_SLICES && fuzz_check_fork(c))
+                bad = 1;
+
+        for (int p = 0; p < NR_FUZZ_POLICY; p++)
+                for (int q = 0; q < 2; q++)
+                        free(r[p][q].segs);
+        if (bad)
+                abort();
+}
+
+static struct fuzz_case *fuzz_case;
+
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size)
+{
+        if (!fuzz_case) {
+                fuzz_case = malloc(sizeof(struct fuzz_case));
+                job_cols_init(&fuzz_case->cols);
+                burst_pool_init(&fuzz_case->bursts);
+        }
+        fuzz_decode(fuzz_case, data, size);
+        fuzz_check(fuzz_case);
+        return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+static unsigned int xorshift(unsigned int *state)
+{
+        unsigned int x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return *state = x;
+}
+
+static int fuzz_file(FILE *in)
+{
+        size_t cap = 1 << 16, size = 0, n;
+        unsigned char *data = malloc(cap);
+
+        while ((n = fread(data + size, 1, cap - size, in)) > 0) {
+                size += n;
+                if (size == cap)
+                        data = realloc(data, cap *= 2);
+        }
+        LLVMFuzzerTestOneInput(data, size);
+        free(data);
+        return 0;
+}
+
+/* 입력 길이도 무작위로 하되 짧은 입력을 더 자주 만든다 */
+static void fuzz_random(const long nr, unsigned int seed)
+{
+        unsigned char *data = malloc(2 * NR_FUZZ_JOBS + 1);
+
+        if (!seed)
+                seed = 2463534242U;
+        for (long it = 0; it < nr; it++) {
+                size_t size = 1 + xorshift(&seed) % (xorshift(&seed) % 8 ?
+                                                     64 : 2 * NR_FUZZ_JOBS);
+
+                for (size_t i = 0; i < size; i++)
+                        data[i] = (unsigned char)xorshift(&seed);
+                LLVMFuzzerTestOneInput(data, size);
+        }
+        free(data);
+        printf("%ld inputs ok\n", nr);
+}
+
+int main(int argc, char *argv[])
+{
+        if (argc > 1 && !strcmp(argv[1], "-r")) {
+                fuzz_random(argc > 2 ? atol(argv[2]) : 100000,
+                            argc > 3 ? (unsigned int)atol(argv[3]) : 0);
+                return 0;
+        }
+        if (argc == 1)
+                return fuzz_file(stdin);
+
+        for (int i = 1; i < argc; i++) {
+                FILE *in = fopen(argv[i], "rb");
+
+                if (!in) {
+                        fprintf(stderr, "cannot open %s\n", argv[i]);
+                        return 1;
+                }
+                fuzz_file(in);
+                fclose(in);
+        }
+        return 0;
+}
+
+#endif
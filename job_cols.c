@@ -0,0 +1,133 @@
+﻿#include <stdlib.h>
+#include "sched.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+static size_t align_up(const size_t size, const size_t align)
+{
+        return (size + align - 1) / align * align;
+}
+
+/**
+* job_cols_map - huge page로 열을 받음
+* @size: 두 열을 합친 크기
+*
+* MAP_HUGETLB로 예약된 huge page를 먼저 시도하고, 없으면 보통 page로
+* 받은 뒤 transparent huge page로 합쳐 달라고 권고한다
+* 리눅스가 아니면 NULL을 돌려줌
+*/
+static void *job_cols_map(const size_t size)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+        void *addr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (addr == MAP_FAILED) {
+                addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (addr == MAP_FAILED)
+                        return NULL;
+#ifdef MADV_HUGEPAGE
+                madvise(addr, size, MADV_HUGEPAGE);
+#endif
+        }
+        return addr;
+#else
+        return NULL;
+#endif
+}
+
+static void *job_cols_alloc(const size_t size)
+{
+#ifdef _WIN32
+        return _aligned_malloc(size, JOB_COLS_ALIGN);
+#else
+        void *addr;
+
+        if (posix_memalign(&addr, JOB_COLS_ALIGN, size))
+                return NULL;
+        return addr;
+#endif
+}
+
+static void job_cols_release(struct job_cols *cols)
+{
+        if (!cols->arrived)
+                return;
+#ifdef _WIN32
+        _aligned_free(cols->arrived);
+#else
+        if (cols->huge)
+                munmap(cols->arrived, cols->size);
+        else
+                free(cols->arrived);
+#endif
+}
+
+/**
+* job_cols_init - 빈 열을 만듦
+* @cols: SoA 열
+*/
+void job_cols_init(struct job_cols *cols)
+{
+        cols->arrived = NULL;
+        cols->amount_time = NULL;
+        cols->cap = 0;
+        cols->huge = 0;
+        cols->size = 0;
+}
+
+/**
+* job_cols_reserve - 열이 job @cnt개를 담을 수 있게 함
+* @cols: SoA 열
+* @cnt: 담을 job 수
+*
+* 모자라면 두 배 이상으로 새로 받으며 이전 내용은 남기지 않는다
+* (케이스마다 처음부터 다시 채우므로)
+* amount_time 열은 arrived 열 뒤의 다음 캐시 라인에서 시작한다
+*/
+void job_cols_reserve(struct job_cols *cols, const int cnt)
+{
+        size_t col, size;
+        char *addr = NULL;
+        int cap;
+
+        if (cols->arrived && cnt <= cols->cap)
+                return;
+
+        cap = max(max(cnt, 1), 2 * cols->cap);
+        col = align_up((size_t)cap * sizeof(sched_time_t), JOB_COLS_ALIGN);
+        size = 2 * col;
+
+        job_cols_release(cols);
+        cols->huge = 0;
+        if (size >= JOB_COLS_HUGE_MIN) {
+                size = align_up(size, JOB_COLS_HUGE_MIN);
+                addr = job_cols_map(size);
+                cols->huge = addr != NULL;
+        }
+        if (!addr)
+                addr = job_cols_alloc(size);
+
+        cols->arrived = (sched_time_t *)addr;
+        cols->amount_time = (sched_time_t *)(addr + col);
+        cols->cap = cap;
+        cols->size = size;
+}
+
+/**
+* job_cols_free - 열의 메모리를 해제
+* @cols: SoA 열
+*/
+void job_cols_free(struct job_cols *cols)
+{
+        job_cols_release(cols);
+        job_cols_init(cols);
+}
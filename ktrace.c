@@ -0,0 +1,785 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "ktrace.h"
+
+/* 한 번에 읽는 크기, 이보다 긴 줄은 버린다 */
+#define KTRACE_BUF_SIZE         (1 << 22)
+#define NR_KTRACE_STAGE         (1 << 16)
+
+/*
+ * task의 상태
+ * KT_NEW는 처음 본 task, KT_DEAD는 끝나서 pid가 다시 쓰일 수 있는 task
+ */
+enum ktrace_state {
+        KT_NEW,
+        KT_SLEEP,
+        KT_READY,
+        KT_RUN,
+        KT_DEAD
+};
+
+/*
+ * @arrived_ns, @run_ns, @seq: 지금 burst가 시작된 시간, CPU를 쓴 시간,
+ *                             시작된 순서
+ * @on_cpu_ns: 마지막으로 CPU를 얻은 시간
+ * @sleep_ns: 마지막으로 잠든 시간
+ * @first, @first_seq, @bursts: burst 모드에서 첫 burst의 도착 시간과
+ *                              순서, 지금까지의 CPU/I/O burst 목록
+ * @dropped: burst 모드에서 시간이 넘쳐 통째로 버린 task
+ * @open_prev, @open_next: -w로 쓸 때 진행 중인 burst 목록에서 앞뒤 task
+ * @held, @held_tail: 이 burst가 끝나기를 기다리는 job 목록의 처음과 끝
+ */
+struct ktrace_task {
+        int                             pid;
+        int                             state;
+        long long                       arrived_ns;
+        long long                       run_ns;
+        long long                       on_cpu_ns;
+        long long                       sleep_ns;
+        long long                       seq;
+        sched_time_t                    first;
+        long long                       first_seq;
+        sched_time_t                    *bursts;
+        int                             nr_bursts;
+        int                             burst_cap;
+        int                             dropped;
+        int                             open_prev;
+        int                             open_next;
+        int                             held;
+        int                             held_tail;
+};
+
+/* 앞선 burst가 끝나기를 기다리는 job, @next는 kt->held 안의 번호 */
+struct ktrace_held {
+        struct serve_job                job;
+        int                             next;
+};
+
+/**
+* ktrace_init - importer를 준비
+* @kt: importer
+* @unit_ns: 시간 1이 몇 나노초인지
+* @bursts: 1이면 task 하나를 CPU/I/O burst가 번갈아 나오는 job 하나로 만듦
+* @out: NULL이 아니면 burst를 struct serve_job으로 바로 써 넣을 파일
+*/
+void ktrace_init(struct ktrace *kt, const long long unit_ns, const int bursts,
+                 FILE *out)
+{
+        kt->unit_ns = unit_ns > 0 ? unit_ns : KTRACE_UNIT_NS;
+        kt->bursts = out ? 0 : bursts;
+        kt->out = out;
+        kt->tasks = NULL;
+        kt->nr_tasks = 0;
+        kt->task_cap = 0;
+        kt->hash_mask = 1023;
+        kt->hash = malloc((kt->hash_mask + 1) * sizeof(int));
+        for (int i = 0; i <= kt->hash_mask; i++)
+                kt->hash[i] = -1;
+        kt->jobs = NULL;
+        kt->nr_job_buf = 0;
+        kt->job_cap = 0;
+        kt->stage = out ? malloc(NR_KTRACE_STAGE * sizeof(struct serve_job)) :
+                          NULL;
+        kt->nr_stage = 0;
+        kt->open_head = -1;
+        kt->open_tail = -1;
+        kt->held = NULL;
+        kt->held_cap = 0;
+        kt->held_free = -1;
+        kt->started = 0;
+        kt->start_ns = 0;
+        kt->last_ns = 0;
+        kt->seq = 0;
+        kt->nr_lines = 0;
+        kt->nr_events = 0;
+        kt->nr_jobs = 0;
+        kt->nr_dropped = 0;
+}
+
+/**
+* ktrace_free - importer의 메모리를 해제
+* @kt: importer
+*/
+void ktrace_free(struct ktrace *kt)
+{
+        for (int i = 0; i < kt->nr_tasks; i++)
+                free(kt->tasks[i].bursts);
+        free(kt->tasks);
+        free(kt->hash);
+        free(kt->jobs);
+        free(kt->stage);
+        free(kt->held);
+}
+
+static inline unsigned int kt_hash(const int pid)
+{
+        return (unsigned int)pid * 2654435761U;
+}
+
+static void kt_rehash(struct ktrace *kt)
+{
+        const int mask = 2 * kt->hash_mask + 1;
+        int *hash = malloc((mask + 1) * sizeof(int));
+
+        for (int i = 0; i <= mask; i++)
+                hash[i] = -1;
+        for (int i = 0; i <= kt->hash_mask; i++) {
+                unsigned int h;
+
+                if (kt->hash[i] < 0)
+                        continue;
+                h = kt_hash(kt->tasks[kt->hash[i]].pid) & mask;
+                while (hash[h] >= 0)
+                        h = (h + 1) & mask;
+                hash[h] = kt->hash[i];
+        }
+        free(kt->hash);
+        kt->hash = hash;
+        kt->hash_mask = mask;
+}
+
+static int kt_new_task(struct ktrace *kt, const int pid)
+{
+        struct ktrace_task *task;
+
+        if (kt->nr_tasks == kt->task_cap) {
+                kt->task_cap = kt->task_cap ? 2 * kt->task_cap : 1024;
+                kt->tasks = realloc(kt->tasks, kt->task_cap *
+                                    sizeof(struct ktrace_task));
+        }
+        task = kt->tasks + kt->nr_tasks;
+        task->pid = pid;
+        task->state = KT_NEW;
+        task->run_ns = 0;
+        task->bursts = NULL;
+        task->nr_bursts = 0;
+        task->burst_cap = 0;
+        task->dropped = 0;
+        return kt->nr_tasks++;
+}
+
+/**
+* kt_task - pid의 task를 찾음
+* @kt: importer
+* @pid: pid
+*
+* 없거나 끝난 task면 새로 만든다
+* 표는 선형 탐사 해시이고 반 넘게 차면 두 배로 늘린다
+*/
+static struct ktrace_task *kt_task(struct ktrace *kt, const int pid)
+{
+        unsigned int h = kt_hash(pid) & kt->hash_mask;
+
+        while (kt->hash[h] >= 0) {
+                struct ktrace_task *task = kt->tasks + kt->hash[h];
+
+                if (task->pid == pid) {
+                        if (task->state == KT_DEAD)
+                                kt->hash[h] = kt_new_task(kt, pid);
+                        return kt->tasks + kt->hash[h];
+                }
+                h = (h + 1) & kt->hash_mask;
+        }
+
+        kt->hash[h] = kt_new_task(kt, pid);
+        if (2 * kt->nr_tasks > kt->hash_mask) {
+                kt_rehash(kt);
+                return kt->tasks + kt->nr_tasks - 1;
+        }
+        return kt->tasks + kt->hash[h];
+}
+
+/* 시간의 길이를 단위로 바꿈, 0보다 긴 시간은 적어도 1 */
+static inline long long kt_units(const struct ktrace *kt, const long long ns)
+{
+        return ns > 0 ? (ns + kt->unit_ns - 1) / kt->unit_ns : 0;
+}
+
+static void kt_push_burst(struct ktrace_task *task, const sched_time_t time)
+{
+        if (task->nr_bursts == task->burst_cap) {
+                task->burst_cap = task->burst_cap ? 2 * task->burst_cap : 4;
+                task->bursts = realloc(task->bursts, task->burst_cap *
+                                       sizeof(sched_time_t));
+        }
+        task->bursts[task->nr_bursts++] = time;
+}
+
+static void kt_flush(struct ktrace *kt)
+{
+        fwrite(kt->stage, sizeof(struct serve_job), kt->nr_stage, kt->out);
+        kt->nr_stage = 0;
+}
+
+static void kt_emit(struct ktrace *kt, const struct serve_job *job)
+{
+        kt->stage[kt->nr_stage] = *job;
+        if (++kt->nr_stage == NR_KTRACE_STAGE)
+                kt_flush(kt);
+}
+
+/* burst가 도착한 시간 */
+static inline long long kt_arrival(const struct ktrace *kt,
+                                   const struct ktrace_task *task)
+{
+        return (task->arrived_ns - kt->start_ns) / kt->unit_ns;
+}
+
+static void kt_open(struct ktrace *kt, struct ktrace_task *task)
+{
+        const int idx = task - kt->tasks;
+
+        task->open_prev = kt->open_tail;
+        task->open_next = -1;
+        task->held = -1;
+        task->held_tail = -1;
+        if (kt->open_tail >= 0)
+                kt->tasks[kt->open_tail].open_next = idx;
+        else
+                kt->open_head = idx;
+        kt->open_tail = idx;
+}
+
+static int kt_hold(struct ktrace *kt, const struct serve_job *job)
+{
+        int h = kt->held_free;
+
+        if (h < 0) {
+                kt->held = realloc(kt->held, (kt->held_cap + 64) *
+                                   sizeof(struct ktrace_held));
+                for (int i = 0; i < 64; i++)
+                        kt->held[kt->held_cap + i].next =
+                                i < 63 ? kt->held_cap + i + 1 : -1;
+                h = kt->held_cap;
+                kt->held_cap += 64;
+        }
+        kt->held_free = kt->held[h].next;
+        kt->held[h].job = *job;
+        return h;
+}
+
+/**
+* kt_close - -w로 쓸 때 진행 중인 burst 목록에서 @task를 빼고 job을 씀
+* @kt: importer
+* @task: burst가 끝난 task
+* @job: 쓸 job, 버린 burst면 NULL
+*
+* ooc_simulate는 도착 시간으로만 안정 정렬하므로 같은 시간에 도착한 job은
+* 파일에 burst가 시작된 순서로 있어야 -i와 같은 순서가 된다
+* 목록은 시작된 순서이고 시작된 순서는 도착 순서와 같으므로, 목록에서
+* 바로 앞의 burst가 같은 시간에 도착했을 때만 기다리면 된다
+* 그때는 @job과 @task를 기다리던 job들을 앞 burst의 목록 뒤에 붙인다
+* (모두 앞 burst보다 늦게 시작했으므로 순서가 유지된다)
+*/
+static void kt_close(struct ktrace *kt, struct ktrace_task *task,
+                     const struct serve_job *job)
+{
+        struct ktrace_task *prev = task->open_prev >= 0 ?
+                                   kt->tasks + task->open_prev : NULL;
+        int h, next;
+
+        if (prev && kt_arrival(kt, prev) == kt_arrival(kt, task)) {
+                if (job) {
+                        h = kt_hold(kt, job);
+                        kt->held[h].next = task->held;
+                        task->held = h;
+                        if (task->held_tail < 0)
+                                task->held_tail = h;
+                }
+                if (task->held >= 0) {
+                        if (prev->held_tail >= 0)
+                                kt->held[prev->held_tail].next = task->held;
+                        else
+                                prev->held = task->held;
+                        prev->held_tail = task->held_tail;
+                }
+        } else {
+                if (job)
+                        kt_emit(kt, job);
+                for (h = task->held; h >= 0; h = next) {
+                        kt_emit(kt, &kt->held[h].job);
+                        next = kt->held[h].next;
+                        kt->held[h].next = kt->held_free;
+                        kt->held_free = h;
+                }
+        }
+
+        if (prev)
+                prev->open_next = task->open_next;
+        else
+                kt->open_head = task->open_next;
+        if (task->open_next >= 0)
+                kt->tasks[task->open_next].open_prev = task->open_prev;
+        else
+                kt->open_tail = task->open_prev;
+}
+
+/**
+* kt_begin - task의 CPU burst를 시작
+* @kt: importer
+* @task: 깨어난 (또는 깨어난 줄 없이 CPU를 얻은) task
+* @now: 시간
+*
+* burst 모드에서 앞선 CPU burst가 있으면 잠든 시간을 I/O burst로 넣는다
+*/
+static void kt_begin(struct ktrace *kt, struct ktrace_task *task,
+                     const long long now)
+{
+        if (task->nr_bursts)
+                kt_push_burst(task, (sched_time_t)min(kt_units(kt, now -
+                              task->sleep_ns), SCHED_TIME_MAX));
+        task->state = KT_READY;
+        task->arrived_ns = now;
+        task->run_ns = 0;
+        task->seq = kt->seq++;
+        if (kt->out)
+                kt_open(kt, task);
+}
+
+/**
+* kt_end_burst - burst 모드에서 task의 CPU burst를 목록에 넣음
+* @kt: importer
+* @task: 잠드는 task
+* @arrived: burst가 도착한 시간
+* @amount: CPU를 쓴 시간
+*
+* 도착 시간은 첫 burst만 쓰므로 첫 burst만 확인한다
+* burst 하나를 빼면 CPU/I/O가 번갈아 나오는 순서가 어긋나므로
+* 시간이 넘치면 task를 통째로 버리고 그 CPU burst를 모두 버린 수로 센다
+*/
+static void kt_end_burst(struct ktrace *kt, struct ktrace_task *task,
+                         const long long arrived, const long long amount)
+{
+        if (task->dropped) {
+                kt->nr_dropped++;
+                return;
+        }
+        if ((!task->nr_bursts && arrived > SCHED_TIME_MAX) ||
+            amount > SCHED_TIME_MAX) {
+                if (task->nr_bursts)
+                        kt->nr_jobs--;
+                kt->nr_dropped += task->nr_bursts / 2 + 1;
+                free(task->bursts);
+                task->bursts = NULL;
+                task->nr_bursts = 0;
+                task->burst_cap = 0;
+                task->dropped = 1;
+                return;
+        }
+
+        if (!task->nr_bursts) {
+                task->first = (sched_time_t)arrived;
+                task->first_seq = task->seq;
+                kt->nr_jobs++;
+        }
+        kt_push_burst(task, (sched_time_t)amount);
+}
+
+/**
+* kt_end - task의 CPU burst를 끝내고 job으로 내보냄
+* @kt: importer
+* @task: 잠드는 task
+* @now: 시간
+*/
+static void kt_end(struct ktrace *kt, struct ktrace_task *task,
+                   const long long now)
+{
+        long long arrived = kt_arrival(kt, task);
+        long long amount = max(kt_units(kt, task->run_ns), 1);
+
+        task->state = KT_SLEEP;
+        task->sleep_ns = now;
+        if (kt->bursts) {
+                kt_end_burst(kt, task, arrived, amount);
+                return;
+        }
+        if (arrived > SCHED_TIME_MAX || amount > SCHED_TIME_MAX) {
+                kt->nr_dropped++;
+                if (kt->out)
+                        kt_close(kt, task, NULL);
+                return;
+        }
+
+        kt->nr_jobs++;
+        if (kt->out) {
+                struct serve_job job = {
+                        .arrived = (sched_time_t)arrived,
+                        .amount_time = (sched_time_t)amount
+                };
+
+                kt_close(kt, task, &job);
+                return;
+        }
+        if (kt->nr_job_buf == kt->job_cap) {
+                kt->job_cap = kt->job_cap ? 2 * kt->job_cap : 1 << 16;
+                kt->jobs = realloc(kt->jobs, kt->job_cap *
+                                   sizeof(struct ktrace_job));
+        }
+        kt->jobs[kt->nr_job_buf].arrived = (sched_time_t)arrived;
+        kt->jobs[kt->nr_job_buf].amount_time = (sched_time_t)amount;
+        kt->jobs[kt->nr_job_buf].seq = task->seq;
+        kt->nr_job_buf++;
+}
+
+static void kt_wakeup(struct ktrace *kt, const int pid, const long long now)
+{
+        struct ktrace_task *task;
+
+        if (!pid)
+                return;
+        task = kt_task(kt, pid);
+        if (task->state == KT_NEW || task->state == KT_SLEEP)
+                kt_begin(kt, task, now);
+}
+
+/**
+* kt_switch - CPU가 @prev에서 @next로 넘어감
+* @kt: importer
+* @prev: CPU를 내놓는 task의 pid (0은 idle)
+* @state: @prev의 prev_state 첫 글자
+* @dead: @prev가 끝났는지 (prev_state에 X나 Z가 있음)
+* @next: CPU를 얻는 task의 pid
+* @now: 시간
+*/
+static void kt_switch(struct ktrace *kt, const int prev, const char state,
+                      const int dead, const int next, const long long now)
+{
+        struct ktrace_task *task;
+
+        if (prev) {
+                task = kt_task(kt, prev);
+                if (task->state == KT_RUN) {
+                        task->run_ns += now - task->on_cpu_ns;
+                        task->state = KT_READY;
+                }
+                if (state == 'R' && !dead) {
+                        if (task->state != KT_READY)
+                                kt_begin(kt, task, now);
+                } else {
+                        if (task->state == KT_READY)
+                                kt_end(kt, task, now);
+                        task->state = dead ? KT_DEAD : KT_SLEEP;
+                        task->sleep_ns = now;
+                }
+        }
+
+        if (next) {
+                task = kt_task(kt, next);
+                if (task->state != KT_READY && task->state != KT_RUN)
+                        kt_begin(kt, task, now);
+                task->state = KT_RUN;
+                task->on_cpu_ns = now;
+        }
+}
+
+static inline int kt_digit(const char c)
+{
+        return c >= '0' && c <= '9';
+}
+
+/**
+* kt_find - 줄에서 "@key=" 꼴의 필드를 찾아 값의 시작을 돌려줌
+* @p: 찾기 시작할 곳
+* @e: 줄의 끝
+* @key: 필드 이름과 '='
+* @len: @key의 길이
+*
+* 필드는 줄 처음이나 공백 뒤에서 시작해야 한다. 없으면 NULL
+*/
+static const char *kt_find(const char *p, const char *e, const char *key,
+                           const size_t len)
+{
+        const char *start = p;
+
+        while ((size_t)(e - p) >= len) {
+                p = memchr(p, key[0], e - p - len + 1);
+                if (!p)
+                        return NULL;
+                if ((p == start || p[-1] == ' ') && !memcmp(p, key, len))
+                        return p + len;
+                p++;
+        }
+        return NULL;
+}
+
+static inline int kt_int(const char *p, const char *e)
+{
+        int v = 0;
+
+        while (p < e && kt_digit(*p))
+                v = v * 10 + (*p++ - '0');
+        return v;
+}
+
+/**
+* kt_stamp - 줄에서 timestamp를 찾아 나노초로 읽음
+* @p: 줄의 시작
+* @e: 줄의 끝
+* @ns: 읽은 시간
+*
+* timestamp는 "초.소수:" 뒤에 공백이 오는 첫 토큰이다
+* (comm에 ':'가 들어갈 수 있으므로 토큰 전체를 확인한다)
+* timestamp 바로 뒤를 돌려주며, 없으면 NULL
+*/
+static const char *kt_stamp(const char *p, const char *e, long long *ns)
+{
+        const char *q = p;
+
+        while ((q = memchr(q, ':', e - q)) != NULL) {
+                const char *s = q;
+                long long sec = 0, frac = 0;
+                int dot = 0, nr_frac = 0;
+
+                while (s > p && (kt_digit(s[-1]) || s[-1] == '.'))
+                        s--;
+                if (q + 1 < e && q[1] == ' ' && s < q &&
+                    (s == p || s[-1] == ' ')) {
+                        for (; s < q; s++) {
+                                if (*s == '.')
+                                        dot++;
+                                else if (!dot)
+                                        sec = sec * 10 + (*s - '0');
+                                else if (nr_frac++ < 9)
+                                        frac = frac * 10 + (*s - '0');
+                        }
+                        if (dot == 1) {
+                                for (; nr_frac < 9; nr_frac++)
+                                        frac *= 10;
+                                *ns = sec * 1000000000LL + frac;
+                                return q + 1;
+                        }
+                }
+                q++;
+        }
+        return NULL;
+}
+
+#define KT_KEY(s)       s, sizeof(s) - 1
+
+/**
+* kt_line - 줄 하나를 처리
+* @kt: importer
+* @p: 줄의 시작
+* @e: 줄의 끝 ('\n' 자리)
+*
+* "timestamp: [sched:]event: 필드들" 꼴의 줄에서 필요한 이벤트만 본다
+*/
+static void kt_line(struct ktrace *kt, const char *p, const char *e)
+{
+        const char *q, *v;
+        long long now;
+        size_t len;
+
+        kt->nr_lines++;
+        if (p == e || *p == '#')
+                return;
+        p = kt_stamp(p, e, &now);
+        if (!p)
+                return;
+        while (p < e && *p == ' ')
+                p++;
+        if (e - p > 6 && !memcmp(p, "sched:", 6))
+                p += 6;
+        q = memchr(p, ':', e - p);
+        if (!q)
+                return;
+        len = q - p;
+        if (len < 12 || memcmp(p, "sched_", 6))
+                return;
+
+        if (!kt->started) {
+                kt->started = 1;
+                kt->start_ns = now;
+        }
+        now = max(now, kt->last_ns);
+        kt->last_ns = now;
+
+        if (len == 12 && !memcmp(p, "sched_switch", 12)) {
+                const char *arrow;
+                int prev, next, dead = 0;
+                char state;
+
+                v = kt_find(q, e, KT_KEY("prev_pid="));
+                if (!v)
+                        return;
+                prev = kt_int(v, e);
+                v = kt_find(v, e, KT_KEY("prev_state="));
+                if (!v || v == e)
+                        return;
+                state = *v;
+                for (; v < e && *v != ' '; v++)
+                        if (*v == 'X' || *v == 'Z')
+                                dead = 1;
+                arrow = kt_find(v, e, KT_KEY("==>"));
+                v = arrow ? kt_find(arrow, e, KT_KEY("next_pid=")) : NULL;
+                if (!v)
+                        return;
+                next = kt_int(v, e);
+                kt_switch(kt, prev, state, dead, next, now);
+        } else if ((len == 12 && !memcmp(p, "sched_wakeup", 12)) ||
+                   (len == 16 && !memcmp(p, "sched_wakeup_new", 16))) {
+                v = kt_find(q, e, KT_KEY("pid="));
+                if (!v)
+                        return;
+                kt_wakeup(kt, kt_int(v, e), now);
+        } else {
+                return;
+        }
+        kt->nr_events++;
+}
+
+/**
+* ktrace_feed - 버퍼에 있는 줄들을 처리
+* @kt: importer
+* @buf: trace의 일부
+* @len: @buf의 길이
+*
+* 끝까지 다 처리한 줄의 바이트 수를 돌려줌 (나머지는 다음 버퍼와 이어 붙임)
+*/
+size_t ktrace_feed(struct ktrace *kt, const char *buf, const size_t len)
+{
+        const char *p = buf, *e = buf + len, *nl;
+
+        while ((nl = memchr(p, '\n', e - p)) != NULL) {
+                kt_line(kt, p, nl > p && nl[-1] == '\r' ? nl - 1 : nl);
+                p = nl + 1;
+        }
+        return p - buf;
+}
+
+/**
+* ktrace_read - 파일 하나를 끝까지 읽어 처리
+* @kt: importer
+* @in: trace 파일
+*
+* KTRACE_BUF_SIZE보다 긴 줄은 다음 '\n'까지 통째로 버린다 (잘린 뒷부분을
+* 새 줄로 읽지 않도록). 읽기 오류면 -1
+*/
+int ktrace_read(struct ktrace *kt, FILE *in)
+{
+        char *buf = malloc(KTRACE_BUF_SIZE + 1);
+        size_t fill = 0, n;
+        int skip = 0;
+
+        while ((n = fread(buf + fill, 1, KTRACE_BUF_SIZE - fill, in)) > 0) {
+                size_t done = 0;
+
+                fill += n;
+                if (skip) {
+                        const char *nl = memchr(buf, '\n', fill);
+
+                        if (!nl) {
+                                fill = 0;
+                                continue;
+                        }
+                        done = nl + 1 - buf;
+                        skip = 0;
+                }
+                done += ktrace_feed(kt, buf + done, fill - done);
+                if (!done && fill == KTRACE_BUF_SIZE) {
+                        done = fill;
+                        skip = 1;
+                }
+                memmove(buf, buf + done, fill - done);
+                fill -= done;
+        }
+        if (fill) {
+                buf[fill] = '\n';
+                ktrace_feed(kt, buf, fill + 1);
+        }
+
+        free(buf);
+        return ferror(in) ? -1 : 0;
+}
+
+/**
+* ktrace_finish - trace가 끝날 때 진행 중인 burst를 마지막 시간에 끝냄
+* @kt: importer
+*
+* -w로 쓸 때는 남은 job을 모두 써 넣는다
+*/
+void ktrace_finish(struct ktrace *kt)
+{
+        for (int i = 0; i < kt->nr_tasks; i++) {
+                struct ktrace_task *task = kt->tasks + i;
+
+                if (task->state == KT_RUN) {
+                        task->run_ns += kt->last_ns - task->on_cpu_ns;
+                        task->state = KT_READY;
+                }
+                if (task->state == KT_READY && task->run_ns)
+                        kt_end(kt, task, kt->last_ns);
+        }
+        /* CPU를 한 번도 쓰지 못한 burst는 job이 없다 */
+        while (kt->open_head >= 0)
+                kt_close(kt, kt->tasks + kt->open_head, NULL);
+        if (kt->out && kt->nr_stage)
+                kt_flush(kt);
+}
+
+static int kt_job_cmp(const void *a, const void *b)
+{
+        const struct ktrace_job *x = a, *y = b;
+
+        if (x->arrived != y->arrived)
+                return x->arrived < y->arrived ? -1 : 1;
+        return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+/**
+* ktrace_write_case - 모은 job들을 test/testinput.txt 꼴의 케이스 하나로 씀
+* @kt: ktrace_finish까지 마친 importer
+* @out: 출력
+*
+* job은 도착 순서로, 같은 시간이면 burst가 시작된 순서로 정렬한다
+* burst 모드면 main -b가 읽는 "arrival time, burst 수, burst들" 꼴로 쓴다
+*/
+void ktrace_write_case(struct ktrace *kt, FILE *out)
+{
+        if (!kt->bursts) {
+                if (kt->nr_job_buf)
+                        qsort(kt->jobs, kt->nr_job_buf,
+                              sizeof(struct ktrace_job), kt_job_cmp);
+                fprintf(out, "1\n%lld\n", kt->nr_job_buf);
+                for (long long i = 0; i < kt->nr_job_buf; i++)
+                        fprintf(out, "%d %d\n", kt->jobs[i].arrived,
+                                kt->jobs[i].amount_time);
+                return;
+        }
+
+        kt->nr_job_buf = 0;
+        for (int i = 0; i < kt->nr_tasks; i++) {
+                struct ktrace_task *task = kt->tasks + i;
+
+                if (!task->nr_bursts)
+                        continue;
+                if (kt->nr_job_buf == kt->job_cap) {
+                        kt->job_cap = kt->job_cap ? 2 * kt->job_cap : 1024;
+                        kt->jobs = realloc(kt->jobs, kt->job_cap *
+                                           sizeof(struct ktrace_job));
+                }
+                /* 정렬하는 동안 amount_time 자리에 task 번호를 둔다 */
+                kt->jobs[kt->nr_job_buf].arrived = task->first;
+                kt->jobs[kt->nr_job_buf].amount_time = i;
+                kt->jobs[kt->nr_job_buf].seq = task->first_seq;
+                kt->nr_job_buf++;
+        }
+        if (kt->nr_job_buf)
+                qsort(kt->jobs, kt->nr_job_buf, sizeof(struct ktrace_job),
+                      kt_job_cmp);
+
+        fprintf(out, "1\n%lld\n", kt->nr_job_buf);
+        for (long long i = 0; i < kt->nr_job_buf; i++) {
+                struct ktrace_task *task = kt->tasks +
+                                           kt->jobs[i].amount_time;
+                int nr = task->nr_bursts;
+
+                /* 마지막은 CPU burst여야 한다 */
+                if (nr % 2 == 0)
+                        nr--;
+                fprintf(out, "%d %d", task->first, nr);
+                for (int k = 0; k < nr; k++)
+                        fprintf(out, " %d", task->bursts[k]);
+                fputc('\n', out);
+        }
+}
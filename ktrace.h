@@ -0,0 +1,94 @@
+﻿#ifndef _KTRACE_H
+#define _KTRACE_H
+
+#include <stdio.h>
+#include "serve.h"
+
+/*
+ * 리눅스 스케쥴러 trace를 job 목록으로 바꾸는 importer (main -i <파일>)
+ *
+ * ftrace의 trace 파일이나 perf sched script의 출력에서 sched_switch,
+ * sched_wakeup, sched_wakeup_new 줄만 골라 task마다 상태를 따라간다
+ * 깨어난 (또는 처음 CPU를 얻은) 때부터 잠들 때 (prev_state가 R이 아닌
+ * sched_switch)까지를 CPU burst 하나로 보고, 그 사이 실제로 CPU를 쓴
+ * 시간의 합을 amount time으로 삼는다. 대기 목록에서 기다린 시간은
+ * 스케쥴러가 정할 몫이므로 넣지 않는다
+ * burst 모드에서는 task 하나가 job 하나이고, 잠들었다가 깨어나기까지를
+ * I/O burst로 넣는다
+ *
+ * 시간은 첫 이벤트를 0으로 하고 @unit_ns 나노초를 1로 센다
+ * trace가 시작되기 전에 시작한 burst는 길이를 모르므로 버린다
+ * 줄은 손으로 짠 tokenizer로 한 번만 훑으며 정규식이나 scanf를 쓰지 않는다
+ *
+ * 예시는 test/testinput_ftrace.txt (CRLF 줄이 섞임)와 testinput_perf.txt,
+ * 기대 출력은 -i가 test/testoutput_ftrace.txt, testoutput_perf.txt이고
+ * -i -b가 그 이름 끝에 _b를 붙인 파일이다. CPU를 빼앗긴 (prev_state가 R인)
+ * burst와 X/Z로 끝난 뒤 다시 쓰인 pid를 담고 있다
+ */
+#define KTRACE_UNIT_NS          1000
+
+struct ktrace_task;
+struct ktrace_held;
+
+struct ktrace_job {
+        sched_time_t                    arrived;
+        sched_time_t                    amount_time;
+        long long                       seq;
+};
+
+/*
+ * @out: NULL이 아니면 burst를 끝나는 대로 struct serve_job으로 써 넣음
+ *       (도착 순서로 정렬하지 않으므로 ooc_simulate가 안정 정렬하며,
+ *       같은 시간에 도착한 job은 burst가 시작된 순서로 쓴다)
+ * @jobs: @out이 없고 burst 모드가 아닐 때 모은 burst들
+ * @seq: burst가 시작된 순서, 같은 시간에 도착한 job의 순서를 정함
+ * @open_head, @open_tail: @out에 쓸 때 진행 중인 burst를 시작된 순서로
+ *       이은 목록
+ * @held, @held_cap, @held_free: 앞선 burst를 기다리며 붙잡아 둔 job들
+ * @nr_lines, @nr_events, @nr_jobs, @nr_dropped: 읽은 줄, 처리한 이벤트,
+ *       만든 job, 시간이 sched_time_t를 넘어 버린 burst의 수
+ *       (burst 모드에서는 task를 통째로 버리며 그 CPU burst를 모두 셈)
+ */
+struct ktrace {
+        long long                       unit_ns;
+        int                             bursts;
+        FILE                            *out;
+
+        struct ktrace_task              *tasks;
+        int                             nr_tasks;
+        int                             task_cap;
+        int                             *hash;
+        int                             hash_mask;
+
+        struct ktrace_job               *jobs;
+        long long                       nr_job_buf;
+        long long                       job_cap;
+        struct serve_job                *stage;
+        int                             nr_stage;
+        int                             open_head;
+        int                             open_tail;
+        struct ktrace_held              *held;
+        int                             held_cap;
+        int                             held_free;
+
+        int                             started;
+        long long                       start_ns;
+        long long                       last_ns;
+        long long                       seq;
+
+        long long                       nr_lines;
+        long long                       nr_events;
+        long long                       nr_jobs;
+        long long                       nr_dropped;
+};
+
+extern void ktrace_init(struct ktrace *kt, const long long unit_ns,
+                        const int bursts, FILE *out);
+extern void ktrace_free(struct ktrace *kt);
+extern size_t ktrace_feed(struct ktrace *kt, const char *buf,
+                          const size_t len);
+extern int ktrace_read(struct ktrace *kt, FILE *in);
+extern void ktrace_finish(struct ktrace *kt);
+extern void ktrace_write_case(struct ktrace *kt, FILE *out);
+
+#endif
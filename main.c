@@ -2,43 +2,712 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 #include "sched.h"
+#include "serve.h"
+#include "ooc.h"
+#include "ktrace.h"
+#include "cache.h"
+#include "pipe.h"
+#include "perf.h"
 
-#define print_time(job)                                                 \
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define print_time(out, job, fcfs, ref)                                 \
         do {                                                            \
                 struct time_info ti;                                    \
-                ti = get_fcfs_time(job);                                \
-                printf("%d %d\n", ti.tard_time, ti.resp_time);          \
-                ti = get_sjf_time(job);                                 \
-                printf("%d %d\n", ti.tard_time, ti.resp_time);          \
-                ti = get_rr_time(job);                                  \
-                printf("%d %d\n", ti.tard_time, ti.resp_time);          \
+                ti = (fcfs);                                            \
+                out_printf(out, "%d %d\n", ti.tard_time, ti.resp_time); \
+                ti = get_time(job, CACHE_SJF, get_sjf_time, ref);       \
+                out_printf(out, "%d %d\n", ti.tard_time, ti.resp_time); \
+                ti = get_time(job, CACHE_RR, get_rr_time, ref);         \
+                out_printf(out, "%d %d\n", ti.tard_time, ti.resp_time); \
         } while (0)
 
-static inline void solve_test()
+/*
+ * -b 옵션을 주면 job 한 줄은 "arrival time, burst 수, burst들"이고
+ * burst는 CPU, I/O, CPU, ... 순서로 번갈아 나온다
+ */
+static int burst_mode;
+
+/*
+ * -S 옵션을 주면 job 목록을 arrival time, amount time 열로 나눈 SoA로
+ * 읽는다 (struct job_cols, 큰 목록은 huge page에 놓임)
+ */
+static int soa_mode;
+
+/*
+ * lane마다 job 목록 버퍼를 하나씩 두고 가장 큰 케이스만큼 자란 뒤로는
+ * 케이스 사이에 그대로 다시 쓴다
+ */
+struct job_buf {
+        struct job_info                 *jobs;
+        int                             cap;
+};
+
+struct out_buf {
+        char                            *s;
+        int                             len;
+        int                             cap;
+};
+
+/*
+ * struct case_batch - 한 번에 읽고 풀고 출력하는 NR_FCFS_LANES개의 케이스
+ * 버퍼들은 batch에 딸려 있어서 batch를 다시 쓸 때 그대로 다시 쓴다
+ */
+struct case_batch {
+        int                             cnt;
+        struct job_head                 inp[NR_FCFS_LANES];
+        struct job_buf                  bufs[NR_FCFS_LANES];
+        struct job_cols                 cols[NR_FCFS_LANES];
+        struct burst_pool               pools[NR_FCFS_LANES];
+        struct fcfs_batch               fcfs;
+        struct out_buf                  out;
+        long                            first;
+        struct out_buf                  perf;
+};
+
+/*
+ * -j <n> 옵션을 주면 읽기, 시뮬레이션 n 스레드, 출력을 pipe로 이은
+ * 파이프라인으로 동작한다 (OpenMP가 있을 때만)
+ * batch는 NR_PIPE_SLOTS개를 돌려 쓰고 출력은 원래 순서를 지킨다
+ */
+#define NR_PIPE_SLOTS           32
+
+enum pipe_stage {
+        STAGE_READ,
+        STAGE_SOLVE,
+        STAGE_WRITE,
+        NR_STAGES
+};
+
+static int nr_solvers;
+
+static void out_printf(struct out_buf *out, const char *fmt, ...)
+{
+        va_list ap;
+        int n;
+
+        for (;;) {
+                va_start(ap, fmt);
+                n = vsnprintf(out->s + out->len, out->cap - out->len, fmt, ap);
+                va_end(ap);
+                if (n < out->cap - out->len)
+                        break;
+                out->cap = max(2 * out->cap, out->len + n + 1);
+                out->s = realloc(out->s, out->cap);
+        }
+        out->len += n;
+}
+
+/*
+ * -P 옵션을 주면 정책 하나를 돌릴 때마다 하드웨어 카운터를 재서
+ * 케이스와 정책마다 IPC와 job 하나당 miss 수를 표준 에러로 출력한다
+ * 보고는 batch에 모았다가 출력과 같은 순서로 내보낸다
+ * 번갈아 센 카운터의 값을 늘려 추정한 보고는 끝에 scaled를 붙인다
+ */
+static int perf_mode;
+
+static const char *const policy_name[] = {
+        "fcfs", "sjf", "rr", "edf", "prio", "prio-preempt", "stride",
+        "lottery", "fair"
+};
+
+#define POLICY_FCFS             0
+#define POLICY_FAIR             (CACHE_LOTTERY + 1)
+
+/*
+ * struct case_ref - 정책을 돌릴 때 필요한 케이스의 부가 정보
+ * @hash: 캐시에서 찾을 job 목록의 해시 (cache_mode일 때만)
+ * @id: 입력에서 몇 번째 케이스인지
+ * @perf: 카운터 보고를 모으는 버퍼
+ */
+struct case_ref {
+        unsigned long long              hash;
+        long                            id;
+        struct out_buf                  *perf;
+};
+
+static void perf_count(struct out_buf *out, const struct perf_sample *sample,
+                       const int counter, const int job_cnt)
+{
+        if (sample->count[counter] < 0)
+                out_printf(out, " %s/job -", perf_counter_name[counter]);
+        else
+                out_printf(out, " %s/job %.2f", perf_counter_name[counter],
+                           (double)sample->count[counter] / max(job_cnt, 1));
+}
+
+/* FCFS는 batch 단위로 풀므로 케이스 범위 [@first, @last]로 보고한다 */
+static void perf_report(struct out_buf *out, const long first, const long last,
+                        const int policy, const int job_cnt,
+                        const struct perf_sample *sample)
+{
+        if (first == last)
+                out_printf(out, "perf case %ld", first);
+        else
+                out_printf(out, "perf cases %ld-%ld", first, last);
+        out_printf(out, " %s jobs %d", policy_name[policy], job_cnt);
+        if (sample->count[PERF_CYCLES] < 0)
+                out_printf(out, " cycles -");
+        else
+                out_printf(out, " cycles %lld", sample->count[PERF_CYCLES]);
+        if (perf_ipc(sample) < 0)
+                out_printf(out, " ipc -");
+        else
+                out_printf(out, " ipc %.2f", perf_ipc(sample));
+        perf_count(out, sample, PERF_L1D_MISSES, job_cnt);
+        perf_count(out, sample, PERF_LLC_MISSES, job_cnt);
+        perf_count(out, sample, PERF_BRANCH_MISSES, job_cnt);
+        if (sample->multiplexed)
+                out_printf(out, " scaled");
+        out_printf(out, "\n");
+}
+
+/* 캐시에서 찾은 결과는 시뮬레이션을 하지 않았으므로 보고하지 않는다 */
+static inline struct time_info run_policy(const struct job_head *job,
+                                          const int policy,
+                                          struct time_info (*get)(
+                                                  const struct job_head *),
+                                          const struct case_ref *ref)
+{
+        struct perf_sample sample;
+        struct time_info ti;
+
+        if (!perf_mode)
+                return get(job);
+
+        perf_begin();
+        ti = get(job);
+        perf_end(&sample);
+        perf_report(ref->perf, ref->id, ref->id, policy, job->job_cnt,
+                    &sample);
+        return ti;
+}
+
+/*
+ * -c 옵션을 주면 같은 job 목록의 결과를 캐시해 두었다가 다시 쓰고
+ * -C <파일>을 주면 캐시를 그 파일에 mmap해 실행 사이에도 이어 쓴다
+ * FCFS는 해시를 구하는 것과 비용이 같으므로 캐시하지 않는다
+ */
+static int cache_mode;
+static const char *cache_path;
+static struct result_cache cache;
+
+/* 파이프라인에서는 시뮬레이션 스레드들이 캐시를 함께 쓴다 */
+static inline struct time_info get_time(const struct job_head *job,
+                                        const int policy,
+                                        struct time_info (*get)(
+                                                const struct job_head *),
+                                        const struct case_ref *ref)
+{
+        struct time_info ti;
+        int hit;
+
+        if (!cache_mode)
+                return run_policy(job, policy, get, ref);
+
+#ifdef _OPENMP
+#pragma omp critical(result_cache)
+#endif
+        hit = cache_lookup(&cache, ref->hash, job, policy, &ti);
+        if (!hit) {
+                ti = run_policy(job, policy, get, ref);
+#ifdef _OPENMP
+#pragma omp critical(result_cache)
+#endif
+                cache_insert(&cache, ref->hash, job, policy, &ti);
+        }
+        return ti;
+}
+
+/* -s 옵션을 주면 표준 입출력으로 프레임을 주고받는 데몬 모드 (serve.h) */
+static int serve_mode;
+
+/*
+ * -o <파일>을 주면 메모리보다 큰 trace 파일 하나를 chunk 단위로 읽어
+ * FCFS, SJF, RR의 결과를 케이스 하나처럼 출력한다 (ooc.h)
+ */
+static const char *ooc_path;
+
+static int solve_ooc(void)
+{
+        struct time_info info[NR_SERVE_POLICY];
+
+        if (ooc_simulate(ooc_path, info)) {
+                fprintf(stderr, "cannot read trace %s\n", ooc_path);
+                return 1;
+        }
+        for (int p = 0; p < NR_SERVE_POLICY; p++)
+                printf("%d %d\n", info[p].tard_time, info[p].resp_time);
+        return 0;
+}
+
+/*
+ * -i <파일>을 주면 ftrace나 perf sched script의 trace를 job 목록으로 바꿔
+ * 케이스 하나를 test/testinput.txt 꼴로 출력한다 (ktrace.h)
+ * -b를 같이 주면 burst 꼴로, -w <파일>을 주면 -o가 읽는 trace 파일로 쓴다
+ * -u <ns>는 시간 1의 길이 (기본 1마이크로초)
+ */
+static const char *import_path;
+static const char *import_out;
+static long long import_unit = KTRACE_UNIT_NS;
+
+static int solve_import(void)
+{
+        FILE *in = fopen(import_path, "rb"), *out = NULL;
+        struct ktrace kt;
+        int err;
+
+        if (!in) {
+                fprintf(stderr, "cannot open trace %s\n", import_path);
+                return 1;
+        }
+        if (import_out && !(out = fopen(import_out, "wb"))) {
+                fprintf(stderr, "cannot open %s\n", import_out);
+                fclose(in);
+                return 1;
+        }
+
+        ktrace_init(&kt, import_unit, burst_mode, out);
+        err = ktrace_read(&kt, in);
+        ktrace_finish(&kt);
+        if (!out)
+                ktrace_write_case(&kt, stdout);
+        fprintf(stderr, "%lld lines, %lld events, %lld jobs, %lld dropped\n",
+                kt.nr_lines, kt.nr_events, kt.nr_jobs, kt.nr_dropped);
+        ktrace_free(&kt);
+
+        fclose(in);
+        if (out && fclose(out))
+                err = -1;
+        return err ? 1 : 0;
+}
+
+/*
+ * -p 옵션을 주면 job 한 줄의 기본 열 뒤에 우선순위 열이 오고
+ * 비선점/선점 우선순위 스케쥴링의 결과를 덧붙인다
+ * -t 옵션을 주면 그 뒤에 티켓 수 열이 오고
+ * stride, lottery 스케쥴링의 결과를 덧붙인다
+ * -g 옵션을 주면 그 뒤에 그룹 번호 열이 오고 fair-share 스케쥴링의
+ * 결과와 그룹마다 "그룹 번호, turnaround time, response time" 줄을 덧붙인다
+ * -d 옵션을 주면 job 한 줄의 마지막 열은 상대 deadline이고
+ * 정책마다 deadline을 넘긴 job 수와 총 tardiness를 같이 출력하며
+ * EDF의 결과를 덧붙인다
+ */
+static int prio_mode;
+static int ticket_mode;
+static int group_mode;
+static int deadline_mode;
+
+static inline void print_info(struct out_buf *out, const struct time_info ti)
+{
+        if (deadline_mode)
+                out_printf(out, "%d %d %d %d\n", ti.tard_time, ti.resp_time,
+                           ti.miss_cnt, ti.late_time);
+        else
+                out_printf(out, "%d %d\n", ti.tard_time, ti.resp_time);
+}
+
+static inline void print_fair_time(struct out_buf *out,
+                                   const struct job_head *job,
+                                   const struct case_ref *ref)
+{
+        struct perf_sample sample;
+        struct time_info *groups, ti;
+        int nr_groups = 1;
+
+        for (int i = 0; i < job->job_cnt; i++)
+                nr_groups = max(nr_groups, (job->jobs + i)->group + 1);
+
+        groups = malloc(nr_groups * sizeof(struct time_info));
+        if (perf_mode)
+                perf_begin();
+        ti = get_fair_time(job, groups, nr_groups);
+        if (perf_mode) {
+                perf_end(&sample);
+                perf_report(ref->perf, ref->id, ref->id, POLICY_FAIR,
+                            job->job_cnt, &sample);
+        }
+        print_info(out, ti);
+        for (int g = 0; g < nr_groups; g++)
+                out_printf(out, "%d %d %d\n", g, (groups + g)->tard_time,
+                           (groups + g)->resp_time);
+        free(groups);
+}
+
+static inline void print_ext_time(struct out_buf *out,
+                                  const struct job_head *job,
+                                  const struct time_info fcfs,
+                                  const struct case_ref *ref)
+{
+        print_info(out, fcfs);
+        print_info(out, get_time(job, CACHE_SJF, get_sjf_time, ref));
+        print_info(out, get_time(job, CACHE_RR, get_rr_time, ref));
+        if (deadline_mode)
+                print_info(out, get_time(job, CACHE_EDF, get_edf_time, ref));
+        if (prio_mode) {
+                print_info(out, get_time(job, CACHE_PRIO, get_prio_time,
+                                         ref));
+                print_info(out, get_time(job, CACHE_PRIO_PREEMPT,
+                                         get_prio_preempt_time, ref));
+        }
+        if (ticket_mode) {
+                print_info(out, get_time(job, CACHE_STRIDE, get_stride_time,
+                                         ref));
+                print_info(out, get_time(job, CACHE_LOTTERY,
+                                         get_lottery_time, ref));
+        }
+        if (group_mode)
+                print_fair_time(out, job, ref);
+}
+
+/* 기본 열 뒤에 옵션으로 켜진 열들을 읽음 */
+static inline void read_ext_cols(struct job_info *job)
+{
+        job->prio = 0;
+        if (prio_mode)
+                scanf("%d", &job->prio);
+        job->tickets = 0;
+        if (ticket_mode)
+                scanf("%d", &job->tickets);
+        job->group = 0;
+        if (group_mode)
+                scanf("%d", &job->group);
+        job->deadline = 0;
+        if (deadline_mode)
+                scanf("%d", &job->deadline);
+}
+
+/*
+ * burst 수는 CPU burst로 시작하고 끝나도록 1 이상의 홀수여야 한다
+ * 아니면 다음 job의 열까지 burst로 읽게 되므로 여기서 멈춘다
+ */
+static inline void read_bursts(sched_time_t *arrived,
+                               sched_time_t *amount_time,
+                               struct burst_pool *pool)
+{
+        int nr;
+
+        scanf("%d %d", arrived, &nr);
+        if (nr < 1 || nr % 2 == 0) {
+                fprintf(stderr, "invalid burst count %d\n", nr);
+                exit(1);
+        }
+        *amount_time = 0;
+        for (int k = 0; k < nr; k++) {
+                sched_time_t time;
+
+                scanf("%d", &time);
+                burst_pool_push(pool, time);
+                if (k % 2 == 0)
+                        *amount_time += time;
+        }
+        burst_pool_end_job(pool);
+}
+
+/*
+ * SoA 목록에서 job_info는 나머지 열이 켜져 있을 때만 두고
+ * 그 arrived와 amount_time은 0으로 둔다 (캐시 해시가 일정하도록)
+ */
+static inline void read_test(struct job_head *inp, struct job_buf *buf,
+                             struct job_cols *cols, struct burst_pool *pool)
 {
-        struct job_head inp;
         int job_cnt;
 
         scanf("%d", &job_cnt);
-        inp.jobs = malloc(job_cnt * sizeof(struct job_info));
-        inp.job_cnt = job_cnt;
+        inp->jobs = NULL;
+        inp->job_cnt = job_cnt;
+        inp->bursts = NULL;
+        inp->deadline = deadline_mode;
+        inp->arrived = NULL;
+        inp->amount_time = NULL;
+
+        if (!soa_mode || prio_mode || ticket_mode || group_mode ||
+            deadline_mode) {
+                if (job_cnt > buf->cap) {
+                        free(buf->jobs);
+                        buf->cap = max(job_cnt, 2 * buf->cap);
+                        buf->jobs = malloc(buf->cap *
+                                           sizeof(struct job_info));
+                }
+                inp->jobs = buf->jobs;
+        }
+        if (soa_mode) {
+                job_cols_reserve(cols, job_cnt);
+                inp->arrived = cols->arrived;
+                inp->amount_time = cols->amount_time;
+        }
+        if (burst_mode) {
+                burst_pool_reset(pool);
+                inp->bursts = pool;
+        }
 
-        for (int i = 0; i < job_cnt; i++)
-                scanf("%d %d", &((inp.jobs + i)->arrived),
-                      &((inp.jobs + i)->amount_time));
+        for (int i = 0; i < job_cnt; i++) {
+                sched_time_t arrived, amount_time;
 
-        print_time(&inp);
-        free(inp.jobs);
+                if (burst_mode)
+                        read_bursts(&arrived, &amount_time, pool);
+                else
+                        scanf("%d %d", &arrived, &amount_time);
+                if (soa_mode) {
+                        inp->arrived[i] = arrived;
+                        inp->amount_time[i] = amount_time;
+                        arrived = amount_time = 0;
+                }
+                if (inp->jobs) {
+                        (inp->jobs + i)->arrived = arrived;
+                        (inp->jobs + i)->amount_time = amount_time;
+                        read_ext_cols(inp->jobs + i);
+                }
+        }
+}
+
+static void read_batch(struct case_batch *b, const long first, const int cnt)
+{
+        b->first = first;
+        b->cnt = cnt;
+        for (int i = 0; i < cnt; i++)
+                read_test(b->inp + i, b->bufs + i, b->cols + i,
+                          b->pools + i);
 }
 
-int main(int argc, char *argv)
+/*
+ * FCFS는 케이스 여러 개를 SIMD lane에 나눠 한 번에 계산하므로
+ * NR_FCFS_LANES개씩 읽어 들인 뒤 순서대로 출력한다
+ */
+static void solve_batch(struct case_batch *b)
+{
+        struct time_info fcfs[NR_FCFS_LANES];
+        struct perf_sample sample;
+        const int cnt = b->cnt;
+        int big = 0, nr_jobs = 0;
+
+        for (int i = 0; i < cnt; i++) {
+                if ((b->inp + i)->job_cnt >= 2 * NR_FCFS_PAR_MIN)
+                        big = 1;
+                nr_jobs += (b->inp + i)->job_cnt;
+        }
+
+        b->perf.len = 0;
+        if (perf_mode)
+                perf_begin();
+        if (burst_mode || deadline_mode) {
+                for (int i = 0; i < cnt; i++)
+                        fcfs[i] = get_fcfs_time(b->inp + i);
+        } else if (big) {
+                /* job이 아주 많은 케이스는 lane 하나로 돌리기보다 스레드로 나눔 */
+                for (int i = 0; i < cnt; i++)
+                        fcfs[i] = get_fcfs_time_par(b->inp + i, 0);
+        } else {
+                fcfs_batch_load(&b->fcfs, b->inp, cnt);
+                get_fcfs_time_batch(&b->fcfs, fcfs);
+        }
+        if (perf_mode) {
+                perf_end(&sample);
+                perf_report(&b->perf, b->first, b->first + cnt - 1,
+                            POLICY_FCFS, nr_jobs, &sample);
+        }
+
+        b->out.len = 0;
+        for (int i = 0; i < cnt; i++) {
+                struct case_ref ref = {
+                        .hash = 0,
+                        .id = b->first + i,
+                        .perf = &b->perf
+                };
+
+                if (cache_mode)
+                        ref.hash = cache_hash(b->inp + i);
+                if (deadline_mode || prio_mode || ticket_mode ||
+                    group_mode)
+                        print_ext_time(&b->out, b->inp + i, fcfs[i], &ref);
+                else
+                        print_time(&b->out, b->inp + i, fcfs[i], &ref);
+        }
+}
+
+static void write_batch(const struct case_batch *b)
+{
+        fwrite(b->out.s, 1, b->out.len, stdout);
+        if (b->perf.len)
+                fwrite(b->perf.s, 1, b->perf.len, stderr);
+}
+
+static void init_batch(struct case_batch *b)
+{
+        memset(b, 0, sizeof(struct case_batch));
+        for (int i = 0; i < NR_FCFS_LANES; i++)
+                job_cols_init(b->cols + i);
+        if (burst_mode)
+                for (int i = 0; i < NR_FCFS_LANES; i++)
+                        burst_pool_init(b->pools + i);
+}
+
+static void free_batch(struct case_batch *b)
+{
+        for (int i = 0; i < NR_FCFS_LANES; i++) {
+                free(b->bufs[i].jobs);
+                job_cols_free(b->cols + i);
+                if (burst_mode)
+                        burst_pool_free(b->pools + i);
+        }
+        fcfs_batch_free(&b->fcfs);
+        free(b->out.s);
+        free(b->perf.s);
+}
+
+static void solve_serial(int case_cnt)
+{
+        static struct case_batch batch;
+        long first = 0;
+
+        init_batch(&batch);
+        while (case_cnt > 0) {
+                int cnt = min(case_cnt, NR_FCFS_LANES);
+
+                read_batch(&batch, first, cnt);
+                first += cnt;
+                solve_batch(&batch);
+                write_batch(&batch);
+                case_cnt -= cnt;
+        }
+        free_batch(&batch);
+}
+
+#ifdef _OPENMP
+/*
+ * 스레드 0은 읽기, 마지막 스레드는 출력, 나머지는 시뮬레이션을 맡는다
+ * 읽기와 출력은 batch 순서대로 진행하고 시뮬레이션 스레드들은
+ * pipe_claim으로 batch를 나눠 가지므로 끝나는 순서는 섞여도
+ * 출력은 원래 순서를 지킨다
+ */
+static void solve_pipeline(const int case_cnt)
+{
+        const long nr_batch = (case_cnt + NR_FCFS_LANES - 1) / NR_FCFS_LANES;
+        struct case_batch *slots;
+        struct pipe pipe;
+
+        slots = malloc(NR_PIPE_SLOTS * sizeof(struct case_batch));
+        for (int i = 0; i < NR_PIPE_SLOTS; i++)
+                init_batch(slots + i);
+        pipe_init(&pipe, NR_PIPE_SLOTS, NR_STAGES);
+
+#pragma omp parallel num_threads(nr_solvers + 2)
+        {
+                const int tid = omp_get_thread_num();
+                const int nr_threads = omp_get_num_threads();
+
+                if (nr_threads < 3) {
+                        /* 스레드를 충분히 얻지 못하면 순서대로 푼다 */
+                        for (long k = 0; tid == 0 && k < nr_batch; k++) {
+                                struct case_batch *b = slots;
+
+                                read_batch(b, k * NR_FCFS_LANES,
+                                           min(case_cnt - (int)k *
+                                               NR_FCFS_LANES,
+                                               NR_FCFS_LANES));
+                                solve_batch(b);
+                                write_batch(b);
+                        }
+                } else if (tid == 0) {
+                        for (long k = 0; k < nr_batch; k++) {
+                                pipe_wait(&pipe, k, STAGE_READ);
+                                read_batch(slots + pipe_slot(&pipe, k),
+                                           k * NR_FCFS_LANES,
+                                           min(case_cnt - (int)k *
+                                               NR_FCFS_LANES, NR_FCFS_LANES));
+                                pipe_post(&pipe, k, STAGE_READ);
+                        }
+                } else if (tid == nr_threads - 1) {
+                        for (long k = 0; k < nr_batch; k++) {
+                                pipe_wait(&pipe, k, STAGE_WRITE);
+                                write_batch(slots + pipe_slot(&pipe, k));
+                                pipe_post(&pipe, k, STAGE_WRITE);
+                        }
+                } else {
+                        long k;
+
+                        while ((k = pipe_claim(&pipe)) < nr_batch) {
+                                pipe_wait(&pipe, k, STAGE_SOLVE);
+                                solve_batch(slots + pipe_slot(&pipe, k));
+                                pipe_post(&pipe, k, STAGE_SOLVE);
+                        }
+                        sim_ctx_free();
+                        perf_close();
+                }
+        }
+
+        pipe_free(&pipe);
+        for (int i = 0; i < NR_PIPE_SLOTS; i++)
+                free_batch(slots + i);
+        free(slots);
+}
+#endif
+
+int main(int argc, char *argv[])
 {
         int case_cnt;
 
+        for (int i = 1; i < argc; i++)
+                if (!strcmp(argv[i], "-b"))
+                        burst_mode = 1;
+                else if (!strcmp(argv[i], "-d"))
+                        deadline_mode = 1;
+                else if (!strcmp(argv[i], "-p"))
+                        prio_mode = 1;
+                else if (!strcmp(argv[i], "-t"))
+                        ticket_mode = 1;
+                else if (!strcmp(argv[i], "-g"))
+                        group_mode = 1;
+                else if (!strcmp(argv[i], "-s"))
+                        serve_mode = 1;
+                else if (!strcmp(argv[i], "-S"))
+                        soa_mode = 1;
+                else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+                        ooc_path = argv[++i];
+                else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+                        import_path = argv[++i];
+                else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+                        import_out = argv[++i];
+                else if (!strcmp(argv[i], "-u") && i + 1 < argc)
+                        import_unit = atoll(argv[++i]);
+                else if (!strcmp(argv[i], "-c"))
+                        cache_mode = 1;
+                else if (!strcmp(argv[i], "-C") && i + 1 < argc)
+                        cache_path = argv[++i];
+                else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+                        nr_solvers = atoi(argv[++i]);
+                else if (!strcmp(argv[i], "-P"))
+                        perf_mode = 1;
+        if (serve_mode)
+                return serve(stdin, stdout) ? 1 : 0;
+        if (ooc_path)
+                return solve_ooc();
+        if (import_path)
+                return solve_import();
+        if (cache_path)
+                cache_mode = 1;
+        if (cache_mode && cache_open(&cache, cache_path)) {
+                fprintf(stderr, "cannot open cache %s\n", cache_path);
+                return 1;
+        }
+        if (perf_mode && !perf_available())
+                fprintf(stderr, "perf counters unavailable\n");
+
         scanf("%d", &case_cnt);
-        while (case_cnt--)
-                solve_test();
+#ifdef _OPENMP
+        if (nr_solvers > 0)
+                solve_pipeline(case_cnt);
+        else
+#endif
+                solve_serial(case_cnt);
 
+        if (cache_mode)
+                cache_close(&cache);
+        perf_close();
         return 0;
 }
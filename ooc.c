@@ -0,0 +1,552 @@
+﻿#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include "ooc.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY        0
+#endif
+
+/* 파일을 읽고 쓸 때 한 번에 옮기는 job 수 */
+#define NR_OOC_STAGE    (1 << 16)
+
+#define OOC_REC         ((long long)sizeof(struct serve_job))
+
+static const struct sched_class *const ooc_class[NR_SERVE_POLICY] = {
+        &fcfs_sched_class,
+        &sjf_sched_class,
+        &rr_sched_class
+};
+
+/**
+* ooc_pread - 파일의 @off 위치부터 @len 바이트를 모두 읽음
+* @fd: 파일
+* @buf: 읽은 내용을 담을 곳
+* @len: 읽을 크기
+* @off: 읽을 위치
+*
+* 다 읽지 못하면 -1을 돌려줌
+*/
+static int ooc_pread(const int fd, void *buf, long long len, long long off)
+{
+        char *p = buf;
+
+        while (len > 0) {
+#ifdef _WIN32
+                int n = -1;
+
+                if (_lseeki64(fd, off, SEEK_SET) == off)
+                        n = _read(fd, p, (unsigned int)min(len, 1LL << 30));
+#else
+                ssize_t n = pread(fd, p, (size_t)len, (off_t)off);
+#endif
+                if (n <= 0)
+                        return -1;
+                p += n;
+                off += n;
+                len -= n;
+        }
+        return 0;
+}
+
+/**
+* ooc_pwrite - 파일의 @off 위치에 @len 바이트를 모두 씀
+* @fd: 파일
+* @buf: 쓸 내용
+* @len: 쓸 크기
+* @off: 쓸 위치
+*/
+static int ooc_pwrite(const int fd, const void *buf, long long len,
+                      long long off)
+{
+        const char *p = buf;
+
+        while (len > 0) {
+#ifdef _WIN32
+                int n = -1;
+
+                if (_lseeki64(fd, off, SEEK_SET) == off)
+                        n = _write(fd, p, (unsigned int)min(len, 1LL << 30));
+#else
+                ssize_t n = pwrite(fd, p, (size_t)len, (off_t)off);
+#endif
+                if (n <= 0)
+                        return -1;
+                p += n;
+                off += n;
+                len -= n;
+        }
+        return 0;
+}
+
+/*
+ * 커널에 주는 읽기 힌트 (posix_fadvise가 없으면 아무것도 하지 않음)
+ * 파일 전체는 순차 읽기로 알리고, chunk 하나를 읽으면 다음 chunk를
+ * 미리 읽어 두게 하며, 시뮬레이션이 지나간 chunk는 page cache에서 버린다
+ */
+static void ooc_advise_sequential(const int fd)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+static void ooc_readahead(const int fd, const long long off,
+                          const long long len)
+{
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(fd, (off_t)off, (off_t)len, POSIX_FADV_WILLNEED);
+#endif
+}
+
+static void ooc_drop(const int fd, const long long off, const long long len)
+{
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, (off_t)off, (off_t)len, POSIX_FADV_DONTNEED);
+#endif
+}
+
+static long long ooc_file_size(const int fd)
+{
+#ifdef _WIN32
+        struct _stati64 st;
+
+        if (_fstati64(fd, &st))
+                return -1;
+#else
+        struct stat st;
+
+        if (fstat(fd, &st))
+                return -1;
+#endif
+        return (long long)st.st_size;
+}
+
+/**
+* ooc_sorted - trace가 arrival time 순으로 정렬되어 있는지 확인
+* @fd: trace 파일
+* @nr: job 수
+* @stage: NR_OOC_STAGE개의 임시 공간
+*
+* 정렬되어 있으면 1, 아니면 0, 읽지 못하면 -1을 돌려줌
+*/
+static int ooc_sorted(const int fd, const long long nr,
+                      struct serve_job *stage)
+{
+        sched_time_t last = 0;
+
+        for (long long pos = 0; pos < nr; pos += NR_OOC_STAGE) {
+                int n = (int)min(nr - pos, NR_OOC_STAGE);
+
+                if (ooc_pread(fd, stage, n * OOC_REC, pos * OOC_REC))
+                        return -1;
+                for (int i = 0; i < n; i++) {
+                        if (pos + i && stage[i].arrived < last)
+                                return 0;
+                        last = stage[i].arrived;
+                }
+        }
+
+        return 1;
+}
+
+/**
+* ooc_sort_run - run 하나를 arrival time으로 안정 정렬
+* @jobs: 정렬할 job들
+* @tmp: @jobs만큼의 임시 공간
+* @cnt: job 수
+*
+* 같은 시간에 도착한 job들의 순서는 trace의 순서를 지킨다
+*/
+static void ooc_sort_run(struct serve_job *jobs, struct serve_job *tmp,
+                         const int cnt)
+{
+        for (int width = 1; width < cnt; width *= 2) {
+                for (int lo = 0; lo < cnt; lo += 2 * width) {
+                        int mid = min(lo + width, cnt);
+                        int hi = min(lo + 2 * width, cnt);
+                        int l = lo, r = mid, k = lo;
+
+                        while (l < mid && r < hi)
+                                tmp[k++] = jobs[r].arrived < jobs[l].arrived ?
+                                           jobs[r++] : jobs[l++];
+                        while (l < mid)
+                                tmp[k++] = jobs[l++];
+                        while (r < hi)
+                                tmp[k++] = jobs[r++];
+                }
+                for (int i = 0; i < cnt; i++)
+                        jobs[i] = tmp[i];
+        }
+}
+
+/*
+ * struct ooc_cursor - 병합 중인 run 하나에서 읽는 위치
+ * run의 앞부분은 @buf에 @nr개 읽혀 있고 @head가 다음 job
+ */
+struct ooc_cursor {
+        long long                       pos;
+        long long                       end;
+        struct serve_job                *buf;
+        int                             head;
+        int                             nr;
+};
+
+static int ooc_cursor_fill(struct ooc_cursor *c, const int fd, const int cap)
+{
+        c->nr = (int)min(c->end - c->pos, cap);
+        c->head = 0;
+        if (ooc_pread(fd, c->buf, c->nr * OOC_REC, c->pos * OOC_REC))
+                return -1;
+        c->pos += c->nr;
+        return 0;
+}
+
+/* 다음 job이 더 먼저 도착하거나, 같으면 앞의 run인 커서가 작다 */
+static int ooc_cursor_less(const struct ooc_cursor *a,
+                           const struct ooc_cursor *b)
+{
+        sched_time_t x = a->buf[a->head].arrived;
+        sched_time_t y = b->buf[b->head].arrived;
+
+        return x < y || (x == y && a < b);
+}
+
+static void ooc_heap_down(struct ooc_cursor **heap, const int nr, int i)
+{
+        for (;;) {
+                int l = 2 * i + 1, s = i;
+                struct ooc_cursor *tmp;
+
+                if (l < nr && ooc_cursor_less(heap[l], heap[s]))
+                        s = l;
+                if (l + 1 < nr && ooc_cursor_less(heap[l + 1], heap[s]))
+                        s = l + 1;
+                if (s == i)
+                        return;
+                tmp = heap[i];
+                heap[i] = heap[s];
+                heap[s] = tmp;
+                i = s;
+        }
+}
+
+/**
+* ooc_merge - 붙어 있는 run들을 하나로 병합
+* @in: run들이 있는 파일
+* @out: 병합한 run을 같은 위치에 쓸 파일
+* @from: 첫 run의 시작 (job 단위)
+* @run: run 하나의 길이
+* @to: 마지막 run의 끝
+* @buf: NR_OOC_CHUNK개의 임시 공간
+*
+* run마다 NR_OOC_CHUNK / (2 * NR_OOC_FANIN)개씩 읽어 최소 힙으로 병합하고
+* 출력은 NR_OOC_CHUNK / 2개씩 모아 쓴다
+*/
+static int ooc_merge(const int in, const int out, const long long from,
+                     const long long run, const long long to,
+                     struct serve_job *buf)
+{
+        const int cap = NR_OOC_CHUNK / (2 * NR_OOC_FANIN);
+        struct ooc_cursor cursor[NR_OOC_FANIN], *heap[NR_OOC_FANIN];
+        struct serve_job *obuf = buf + NR_OOC_CHUNK / 2;
+        long long opos = from;
+        int nr = 0, onr = 0;
+
+        for (long long pos = from; pos < to; pos += run) {
+                struct ooc_cursor *c = cursor + nr;
+
+                c->pos = pos;
+                c->end = min(pos + run, to);
+                c->buf = buf + nr * cap;
+                if (ooc_cursor_fill(c, in, cap))
+                        return -1;
+                heap[nr++] = c;
+        }
+        for (int i = nr / 2 - 1; i >= 0; i--)
+                ooc_heap_down(heap, nr, i);
+
+        while (nr) {
+                struct ooc_cursor *c = heap[0];
+
+                obuf[onr++] = c->buf[c->head++];
+                if (onr == NR_OOC_CHUNK / 2) {
+                        if (ooc_pwrite(out, obuf, onr * OOC_REC,
+                                       opos * OOC_REC))
+                                return -1;
+                        opos += onr;
+                        onr = 0;
+                }
+                if (c->head == c->nr) {
+                        if (c->pos == c->end)
+                                heap[0] = heap[--nr];
+                        else if (ooc_cursor_fill(c, in, cap))
+                                return -1;
+                }
+                ooc_heap_down(heap, nr, 0);
+        }
+
+        return ooc_pwrite(out, obuf, onr * OOC_REC, opos * OOC_REC);
+}
+
+/**
+* ooc_sort - trace를 arrival time 순으로 외부 병합 정렬
+* @fd: trace 파일
+* @nr: job 수
+* @tmp: 임시 파일 두 개, 정렬된 trace는 그중 하나에 남음
+*
+* chunk마다 정렬한 run을 만든 뒤 NR_OOC_FANIN개씩 병합하기를
+* run이 하나가 될 때까지 반복한다
+* run들은 파일에서 붙어 있으므로 병합한 run도 같은 자리에 쓴다
+* 정렬된 trace가 있는 파일을 돌려주고, 실패하면 -1
+*/
+static int ooc_sort(const int fd, const long long nr, FILE *tmp[2])
+{
+        struct serve_job *buf = malloc(2 * NR_OOC_CHUNK * OOC_REC);
+        int in = fileno(tmp[0]), out = fileno(tmp[1]);
+        int ret = -1;
+
+        for (long long pos = 0; pos < nr; pos += NR_OOC_CHUNK) {
+                int n = (int)min(nr - pos, NR_OOC_CHUNK);
+
+                if (ooc_pread(fd, buf, n * OOC_REC, pos * OOC_REC))
+                        goto out;
+                ooc_sort_run(buf, buf + NR_OOC_CHUNK, n);
+                if (ooc_pwrite(in, buf, n * OOC_REC, pos * OOC_REC))
+                        goto out;
+        }
+
+        for (long long run = NR_OOC_CHUNK; run < nr; run *= NR_OOC_FANIN) {
+                int swap;
+
+                for (long long pos = 0; pos < nr; pos += run * NR_OOC_FANIN)
+                        if (ooc_merge(in, out, pos, run,
+                                      min(pos + run * NR_OOC_FANIN, nr), buf))
+                                goto out;
+                swap = in;
+                in = out;
+                out = swap;
+        }
+        ret = in;
+out:
+        free(buf);
+        return ret;
+}
+
+/*
+ * struct ooc_chunk - 시뮬레이션에 넣은 trace 한 구간
+ * @seq: 몇 번째로 넣은 chunk인지
+ * @off: 파일에서의 위치 (바이트)
+ */
+struct ooc_chunk {
+        struct ooc_chunk                *next;
+        struct job_cols                 cols;
+        int                             nr;
+        long long                       seq;
+        long long                       off;
+};
+
+struct ooc {
+        int                             fd;
+        long long                       nr_jobs;
+        long long                       pos;
+        struct serve_job                *stage;
+        struct ooc_chunk                *fed;
+        struct ooc_chunk                *fed_tail;
+        struct ooc_chunk                *free;
+        long long                       nr_fed;
+        struct sim                      sim[NR_SERVE_POLICY];
+};
+
+/**
+* ooc_read_chunk - 다음 chunk를 읽어 시뮬레이션들에 넣음
+* @o: out-of-core 시뮬레이션 상태
+*
+* 다 쓴 chunk가 있으면 그 열을 다시 쓰고, 없을 때만 새로 할당한다
+*/
+static int ooc_read_chunk(struct ooc *o)
+{
+        const int nr = (int)min(o->nr_jobs - o->pos, NR_OOC_CHUNK);
+        struct ooc_chunk *chunk = o->free;
+        sched_time_t horizon;
+
+        if (chunk) {
+                o->free = chunk->next;
+        } else {
+                chunk = malloc(sizeof(struct ooc_chunk));
+                job_cols_init(&chunk->cols);
+                job_cols_reserve(&chunk->cols, NR_OOC_CHUNK);
+        }
+        chunk->next = NULL;
+        chunk->nr = nr;
+        chunk->seq = o->nr_fed++;
+        chunk->off = o->pos * OOC_REC;
+        if (o->fed_tail)
+                o->fed_tail->next = chunk;
+        else
+                o->fed = chunk;
+        o->fed_tail = chunk;
+
+        for (int i = 0; i < nr; i += NR_OOC_STAGE) {
+                int n = min(nr - i, NR_OOC_STAGE);
+
+                if (ooc_pread(o->fd, o->stage, n * OOC_REC,
+                              chunk->off + i * OOC_REC))
+                        return -1;
+                for (int k = 0; k < n; k++) {
+                        chunk->cols.arrived[i + k] = o->stage[k].arrived;
+                        chunk->cols.amount_time[i + k] =
+                                o->stage[k].amount_time;
+                }
+        }
+        o->pos += nr;
+        ooc_readahead(o->fd, o->pos * OOC_REC, NR_OOC_CHUNK * OOC_REC);
+
+        /* 다음 chunk가 같은 시간에 도착하는 job으로 시작할 수 있음 */
+        horizon = chunk->cols.arrived[nr - 1] - 1;
+        for (int p = 0; p < NR_SERVE_POLICY; p++) {
+                sim_feed_cols(o->sim + p, chunk->cols.arrived,
+                              chunk->cols.amount_time, nr, horizon);
+                if (o->pos == o->nr_jobs)
+                        sim_close(o->sim + p);
+        }
+        return 0;
+}
+
+/**
+* ooc_reclaim - 모든 시뮬레이션이 지나간 chunk를 돌려받음
+* @o: out-of-core 시뮬레이션 상태
+*/
+static void ooc_reclaim(struct ooc *o)
+{
+        while (o->fed) {
+                struct ooc_chunk *chunk = o->fed;
+
+                for (int p = 0; p < NR_SERVE_POLICY; p++)
+                        if (chunk->seq >= o->nr_fed -
+                                          sim_feed_pending(o->sim + p))
+                                return;
+
+                o->fed = chunk->next;
+                if (!o->fed)
+                        o->fed_tail = NULL;
+                ooc_drop(o->fd, chunk->off, chunk->nr * OOC_REC);
+                chunk->next = o->free;
+                o->free = chunk;
+        }
+}
+
+static void ooc_free_chunks(struct ooc_chunk *chunk)
+{
+        while (chunk) {
+                struct ooc_chunk *next = chunk->next;
+
+                job_cols_free(&chunk->cols);
+                free(chunk);
+                chunk = next;
+        }
+}
+
+/**
+* ooc_run - 정렬된 trace를 chunk 단위로 시뮬레이션
+* @o: 파일과 job 수가 정해진 상태
+*/
+static int ooc_run(struct ooc *o)
+{
+        int ret = 0;
+
+        o->pos = 0;
+        o->fed = NULL;
+        o->fed_tail = NULL;
+        o->free = NULL;
+        o->nr_fed = 0;
+        for (int p = 0; p < NR_SERVE_POLICY; p++)
+                sim_open(o->sim + p, ooc_class[p]);
+        if (!o->nr_jobs)
+                for (int p = 0; p < NR_SERVE_POLICY; p++)
+                        sim_close(o->sim + p);
+
+        ooc_advise_sequential(o->fd);
+        do {
+                if (o->pos < o->nr_jobs && ooc_read_chunk(o)) {
+                        ret = -1;
+                        break;
+                }
+                for (int p = 0; p < NR_SERVE_POLICY; p++)
+                        sim_run(o->sim + p);
+                ooc_reclaim(o);
+        } while (o->pos < o->nr_jobs);
+
+        ooc_free_chunks(o->fed);
+        ooc_free_chunks(o->free);
+        return ret;
+}
+
+/**
+* ooc_simulate - trace 파일을 FCFS, SJF, RR로 시뮬레이션
+* @path: trace 파일
+* @info: 정책마다 결과를 기록 (FCFS, SJF, RR 순서)
+*
+* 파일을 읽지 못하거나 형식이 맞지 않으면 -1을 돌려줌
+*/
+int ooc_simulate(const char *path, struct time_info info[NR_SERVE_POLICY])
+{
+        struct ooc *o = malloc(sizeof(struct ooc));
+        FILE *tmp[2] = { NULL, NULL };
+        long long size;
+        int fd, ret = -1;
+
+        o->stage = malloc(NR_OOC_STAGE * OOC_REC);
+        fd = open(path, O_RDONLY | O_BINARY);
+        if (fd < 0)
+                goto out;
+        size = ooc_file_size(fd);
+        if (size < 0 || size % OOC_REC)
+                goto out;
+
+        o->fd = fd;
+        o->nr_jobs = size / OOC_REC;
+        ooc_advise_sequential(fd);
+        switch (ooc_sorted(fd, o->nr_jobs, o->stage)) {
+        case 0:
+                tmp[0] = tmpfile();
+                tmp[1] = tmpfile();
+                if (!tmp[0] || !tmp[1])
+                        goto out;
+                o->fd = ooc_sort(fd, o->nr_jobs, tmp);
+                if (o->fd < 0)
+                        goto out;
+                break;
+        case 1:
+                break;
+        default:
+                goto out;
+        }
+
+        ret = ooc_run(o);
+        for (int p = 0; p < NR_SERVE_POLICY; p++) {
+                info[p] = o->sim[p].info;
+                sim_destroy(o->sim + p);
+        }
+out:
+        for (int i = 0; i < 2; i++)
+                if (tmp[i])
+                        fclose(tmp[i]);
+        if (fd >= 0)
+                close(fd);
+        free(o->stage);
+        free(o);
+        return ret;
+}
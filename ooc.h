@@ -0,0 +1,23 @@
+﻿#ifndef _OOC_H
+#define _OOC_H
+
+#include "serve.h"
+
+/*
+ * 메모리보다 큰 trace의 시뮬레이션 (main -o <파일>)
+ *
+ * trace 파일은 struct serve_job (arrival time, amount time)의 배열이고
+ * 정수는 호스트 바이트 순서의 32비트다
+ * 파일은 NR_OOC_CHUNK개씩 읽어 SoA chunk로 FCFS, SJF, RR 시뮬레이션에
+ * 넣고, 세 시뮬레이션이 모두 지나간 chunk는 다시 쓰므로 메모리는
+ * chunk 몇 개와 대기 목록만큼만 쓴다
+ * arrival time 순으로 정렬되어 있지 않으면 먼저 임시 파일에 외부
+ * 병합 정렬을 한다 (chunk 단위로 정렬한 run을 NR_OOC_FANIN개씩 병합)
+ */
+#define NR_OOC_CHUNK            (1 << 20)
+#define NR_OOC_FANIN            64
+
+extern int ooc_simulate(const char *path,
+                        struct time_info info[NR_SERVE_POLICY]);
+
+#endif
@@ -0,0 +1,166 @@
+﻿#include <string.h>
+#include "perf.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#ifdef _MSC_VER
+#define __perf_thread   __declspec(thread)
+#else
+#define __perf_thread   _Thread_local
+#endif
+
+const char *const perf_counter_name[NR_PERF_COUNTERS] = {
+        "cycles", "instructions", "l1d-misses", "llc-misses",
+        "branch-misses"
+};
+
+/*
+ * 카운터는 그룹으로 묶지 않고 하나씩 열어서, 지원하지 않는
+ * 카운터가 있어도 나머지는 쓸 수 있게 한다
+ */
+struct perf_ctx {
+        int                             opened;
+        int                             fd[NR_PERF_COUNTERS];
+};
+
+static __perf_thread struct perf_ctx perf_ctx;
+
+#ifdef __linux__
+static const struct {
+        unsigned int                    type;
+        unsigned long long              config;
+} perf_event[NR_PERF_COUNTERS] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                              PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                              PERF_COUNT_HW_CACHE_RESULT_MISS << 16 },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+};
+
+static int perf_open_counter(const int i)
+{
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_event[i].type;
+        attr.config = perf_event[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static struct perf_ctx *perf_get_ctx(void)
+{
+        struct perf_ctx *ctx = &perf_ctx;
+
+        if (ctx->opened)
+                return ctx;
+
+        for (int i = 0; i < NR_PERF_COUNTERS; i++) {
+#ifdef __linux__
+                ctx->fd[i] = perf_open_counter(i);
+#else
+                ctx->fd[i] = -1;
+#endif
+        }
+        ctx->opened = 1;
+        return ctx;
+}
+
+/**
+* perf_available - 이 스레드에서 쓸 수 있는 카운터 수를 구함
+*/
+int perf_available(void)
+{
+        struct perf_ctx *ctx = perf_get_ctx();
+        int nr = 0;
+
+        for (int i = 0; i < NR_PERF_COUNTERS; i++)
+                if (ctx->fd[i] >= 0)
+                        nr++;
+        return nr;
+}
+
+/**
+* perf_begin - 카운터를 0으로 돌리고 세기 시작
+*/
+void perf_begin(void)
+{
+#ifdef __linux__
+        struct perf_ctx *ctx = perf_get_ctx();
+
+        for (int i = 0; i < NR_PERF_COUNTERS; i++) {
+                if (ctx->fd[i] < 0)
+                        continue;
+                ioctl(ctx->fd[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(ctx->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+}
+
+/**
+* perf_end - 세기를 멈추고 perf_begin 이후의 값을 읽음
+* @sample: 카운터 값을 기록, 쓸 수 없는 카운터는 -1
+*
+* 다른 카운터와 번갈아 센 (multiplexing) 카운터는 켜져 있던 시간 중
+* 실제로 센 시간의 비율로 값을 늘리고 @sample->multiplexed에 표시한다
+* 전혀 세지 못했으면 -1
+*/
+void perf_end(struct perf_sample *sample)
+{
+        struct perf_ctx *ctx = perf_get_ctx();
+
+        sample->multiplexed = 0;
+        for (int i = 0; i < NR_PERF_COUNTERS; i++) {
+#ifdef __linux__
+                unsigned long long val[3];
+#endif
+
+                sample->count[i] = -1;
+#ifdef __linux__
+                if (ctx->fd[i] < 0)
+                        continue;
+                ioctl(ctx->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+                if (read(ctx->fd[i], val, sizeof(val)) != sizeof(val) ||
+                    !val[2])
+                        continue;
+                sample->count[i] = (long long)val[0];
+                if (val[2] < val[1]) {
+                        sample->count[i] = (long long)((double)val[0] *
+                                                       val[1] / val[2]);
+                        sample->multiplexed |= 1U << i;
+                }
+#endif
+        }
+}
+
+/**
+* perf_close - 이 스레드의 카운터를 닫음
+*
+* 스레드가 더 이상 측정하지 않을 때 부른다. 다시 쓰면 새로 연다
+*/
+void perf_close(void)
+{
+        struct perf_ctx *ctx = &perf_ctx;
+
+        if (!ctx->opened)
+                return;
+#ifdef __linux__
+        for (int i = 0; i < NR_PERF_COUNTERS; i++)
+                if (ctx->fd[i] >= 0)
+                        close(ctx->fd[i]);
+#endif
+        ctx->opened = 0;
+}
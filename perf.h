@@ -0,0 +1,54 @@
+﻿#ifndef _PERF_H
+#define _PERF_H
+
+/*
+ * 하드웨어 성능 카운터 (리눅스의 perf_event_open)
+ *
+ * perf_begin과 perf_end 사이에 이 스레드가 쓴 cycle, instruction,
+ * L1 데이터 캐시 miss, LLC miss, branch miss를 센다
+ * 카운터는 스레드마다 처음 쓸 때 열고 스레드가 끝나기 전에 perf_close로
+ * 닫는다. 컨테이너 등에서 열 수 없는 카운터는 값이 -1로 나온다
+ * (리눅스가 아니면 모두 -1)
+ */
+enum perf_counter {
+        PERF_CYCLES,
+        PERF_INSTRUCTIONS,
+        PERF_L1D_MISSES,
+        PERF_LLC_MISSES,
+        PERF_BRANCH_MISSES,
+        NR_PERF_COUNTERS
+};
+
+/*
+ * @multiplexed: 하드웨어 카운터가 모자라 구간의 일부에서만 센 카운터들의
+ *               비트 (1 << enum perf_counter). 그 값은 센 시간의 비율로
+ *               늘린 추정치
+ */
+struct perf_sample {
+        long long                       count[NR_PERF_COUNTERS];
+        unsigned int                    multiplexed;
+};
+
+extern const char *const perf_counter_name[NR_PERF_COUNTERS];
+
+extern int perf_available(void);
+extern void perf_begin(void);
+extern void perf_end(struct perf_sample *sample);
+extern void perf_close(void);
+
+/**
+* perf_ipc - 측정 구간의 instruction per cycle을 구함
+* @sample: 측정 결과
+*
+* 카운터가 없으면 음수를 돌려줌
+*/
+static inline double perf_ipc(const struct perf_sample *sample)
+{
+        if (sample->count[PERF_CYCLES] <= 0 ||
+            sample->count[PERF_INSTRUCTIONS] < 0)
+                return -1;
+        return (double)sample->count[PERF_INSTRUCTIONS] /
+               sample->count[PERF_CYCLES];
+}
+
+#endif
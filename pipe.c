@@ -0,0 +1,59 @@
+﻿#include <stdlib.h>
+#include "pipe.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <threads.h>
+#endif
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define pipe_pause()    _mm_pause()
+#else
+#define pipe_pause()    do { } while (0)
+#endif
+
+#define NR_PIPE_SPIN    64
+
+/**
+* pipe_init - 모든 slot이 첫 단계를 기다리는 파이프라인을 만듦
+* @p: 파이프라인
+* @nr_slot: slot 수 (동시에 진행 중일 수 있는 작업 수)
+* @nr_stage: 단계 수
+*/
+void pipe_init(struct pipe *p, const int nr_slot, const int nr_stage)
+{
+        p->nr_slot = nr_slot;
+        p->nr_stage = nr_stage;
+        p->state = calloc(nr_slot, sizeof(long));
+        p->next = 0;
+}
+
+/**
+* pipe_free - 파이프라인의 메모리를 해제
+* @p: 파이프라인
+*/
+void pipe_free(struct pipe *p)
+{
+        free((void *)p->state);
+        p->state = NULL;
+}
+
+/**
+* pipe_relax - 기다리는 동안 CPU를 양보
+* @spins: 지금까지 기다린 횟수
+*
+* 잠깐은 pause로 돌다가 길어지면 스레드를 양보한다
+*/
+void pipe_relax(const int spins)
+{
+        if (spins < NR_PIPE_SPIN)
+                pipe_pause();
+        else
+#ifdef _WIN32
+                SwitchToThread();
+#else
+                thrd_yield();
+#endif
+}
@@ -0,0 +1,112 @@
+﻿#ifndef _PIPE_H
+#define _PIPE_H
+
+/*
+ * struct pipe - 단계들이 slot을 차례로 넘겨받는 lock-free 원형 버퍼
+ *
+ * 작업 k는 slot k % nr_slot을 쓰고, slot의 state는
+ * (k / nr_slot) * nr_stage + (지금 그 slot을 기다리는 단계)이다
+ * 단계 s는 state가 자기 차례가 될 때까지 기다렸다가 일을 마치면
+ * state를 하나 올려 다음 단계에 넘기고, 마지막 단계가 올리면
+ * 곧 다음 바퀴의 작업 k + nr_slot을 받을 차례가 된다
+ * 여러 스레드가 함께 맡는 단계는 pipe_claim으로 작업 번호를 나눠 갖는다
+ * lock 없이 slot마다 state 하나만 주고받으므로 단계 사이의
+ * 동기화 비용은 작업마다 원자적 load/store 몇 번이다
+ */
+struct pipe {
+        int                             nr_slot;
+        int                             nr_stage;
+        volatile long                   *state;
+        volatile long                   next;
+};
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+/* x86의 load와 store는 이미 acquire/release이므로 컴파일러만 막는다 */
+static inline long pipe_load(volatile long *p)
+{
+        long v = *p;
+
+        _ReadWriteBarrier();
+        return v;
+}
+
+static inline void pipe_store(volatile long *p, const long v)
+{
+        _ReadWriteBarrier();
+        *p = v;
+}
+
+static inline long pipe_fetch_inc(volatile long *p)
+{
+        return _InterlockedExchangeAdd(p, 1);
+}
+#else
+static inline long pipe_load(volatile long *p)
+{
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void pipe_store(volatile long *p, const long v)
+{
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline long pipe_fetch_inc(volatile long *p)
+{
+        return __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+extern void pipe_init(struct pipe *p, const int nr_slot, const int nr_stage);
+extern void pipe_free(struct pipe *p);
+extern void pipe_relax(const int spins);
+
+/**
+* pipe_slot - 작업 번호가 쓰는 slot 번호를 구함
+* @p: 파이프라인
+* @k: 작업 번호
+*/
+static inline int pipe_slot(const struct pipe *p, const long k)
+{
+        return (int)(k % p->nr_slot);
+}
+
+/**
+* pipe_wait - 작업 k의 slot이 단계 @stage의 차례가 될 때까지 기다림
+* @p: 파이프라인
+* @k: 작업 번호
+* @stage: 기다리는 단계
+*/
+static inline void pipe_wait(struct pipe *p, const long k, const int stage)
+{
+        const long want = k / p->nr_slot * p->nr_stage + stage;
+        volatile long *state = p->state + pipe_slot(p, k);
+
+        for (int spins = 0; pipe_load(state) != want; spins++)
+                pipe_relax(spins);
+}
+
+/**
+* pipe_post - 단계 @stage가 작업 k를 마쳤음을 알림
+* @p: 파이프라인
+* @k: 작업 번호
+* @stage: 일을 마친 단계
+*/
+static inline void pipe_post(struct pipe *p, const long k, const int stage)
+{
+        pipe_store(p->state + pipe_slot(p, k),
+                   k / p->nr_slot * p->nr_stage + stage + 1);
+}
+
+/**
+* pipe_claim - 여러 스레드가 맡는 단계에서 다음 작업 번호를 가져옴
+* @p: 파이프라인
+*/
+static inline long pipe_claim(struct pipe *p)
+{
+        return pipe_fetch_inc(&p->next);
+}
+
+#endif
@@ -29,6 +29,10 @@ performances and genericity...
 
 #include <stddef.h> 	/* NULL */
 
+#ifndef PACKED_ALIGN
+#define PACKED_ALIGN
+#endif
+
 #ifndef container_of
 #define container_of(ptr, type, member)                         \
 	(type *)( (char *)(ptr) - offsetof(type,member) )
@@ -0,0 +1,88 @@
+﻿#include <stdlib.h>
+#include "reloc.h"
+
+/**
+* reloc_init - 빈 주소 표를 만듦
+* @r: 주소 표
+*/
+void reloc_init(struct reloc *r)
+{
+        r->range = NULL;
+        r->nr = 0;
+        r->cap = 0;
+        r->sorted = 1;
+}
+
+/**
+* reloc_free - 주소 표의 메모리를 해제
+* @r: 주소 표
+*/
+void reloc_free(struct reloc *r)
+{
+        free(r->range);
+        reloc_init(r);
+}
+
+/**
+* reloc_add - 복사한 구간 하나를 표에 넣음
+* @r: 주소 표
+* @from: 원래 구간의 시작
+* @len: 구간의 바이트 수
+* @to: 복사된 구간의 시작
+*/
+void reloc_add(struct reloc *r, const void *from, const size_t len, void *to)
+{
+        if (r->nr == r->cap) {
+                r->cap = r->cap ? r->cap * 2 : 16;
+                r->range = realloc(r->range,
+                                   r->cap * sizeof(struct reloc_range));
+        }
+
+        r->range[r->nr].from = from;
+        r->range[r->nr].len = len;
+        r->range[r->nr].to = to;
+        r->nr++;
+        r->sorted = 0;
+}
+
+static int reloc_cmp(const void *a, const void *b)
+{
+        const struct reloc_range *x = a, *y = b;
+
+        if (x->from != y->from)
+                return x->from < y->from ? -1 : 1;
+        return 0;
+}
+
+/**
+* reloc_ptr - 옛 주소를 새 주소로 바꿈
+* @r: 주소 표
+* @p: 옛 주소
+*
+* 표에 없는 주소는 그대로 돌려줌
+* 구간을 넣은 뒤 처음 부를 때 한 번 정렬한다
+*/
+void *reloc_ptr(struct reloc *r, const void *p)
+{
+        const char *c = p;
+        int lo = 0, hi = r->nr;
+
+        if (!r->sorted) {
+                qsort(r->range, r->nr, sizeof(struct reloc_range), reloc_cmp);
+                r->sorted = 1;
+        }
+
+        /* from이 c 이하인 마지막 구간을 찾음 */
+        while (lo < hi) {
+                int mid = (lo + hi) / 2;
+
+                if (r->range[mid].from <= c)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        if (lo && c < r->range[lo - 1].from + r->range[lo - 1].len)
+                return r->range[lo - 1].to + (c - r->range[lo - 1].from);
+
+        return (void *)p;
+}
@@ -0,0 +1,63 @@
+﻿#ifndef _RELOC_H
+#define _RELOC_H
+
+#include <stddef.h>
+#include "rbtree.h"
+#include "list.h"
+
+/*
+ * struct reloc - 복사한 메모리 구간의 옛 주소를 새 주소로 옮기는 표
+ *
+ * 시뮬레이션을 fork할 때 slab과 정책 상태를 통째로 복사한 뒤
+ * 그 안의 포인터들만 이 표로 고친다
+ * 구간은 옛 주소 순으로 정렬해 이진 탐색하고, 어느 구간에도 들지 않는
+ * 주소 (공유하는 job 목록 등)는 그대로 둔다
+ */
+struct reloc_range {
+        const char                      *from;
+        size_t                          len;
+        char                            *to;
+};
+
+struct reloc {
+        struct reloc_range              *range;
+        int                             nr;
+        int                             cap;
+        int                             sorted;
+};
+
+extern void reloc_init(struct reloc *r);
+extern void reloc_free(struct reloc *r);
+extern void reloc_add(struct reloc *r, const void *from, const size_t len,
+                      void *to);
+extern void *reloc_ptr(struct reloc *r, const void *p);
+
+/**
+* reloc_list - list 항목의 두 포인터를 새 주소로 고침
+* @r: 주소 표
+* @list: 복사된 list 항목
+*/
+static inline void reloc_list(struct reloc *r, struct list_head *list)
+{
+        list->next = reloc_ptr(r, list->next);
+        list->prev = reloc_ptr(r, list->prev);
+}
+
+/**
+* reloc_rb - 레드블랙트리 노드의 포인터들을 새 주소로 고침
+* @r: 주소 표
+* @node: 복사된 노드
+*
+* 부모 포인터의 아래 비트에 들어 있는 색은 그대로 둔다
+*/
+static inline void reloc_rb(struct reloc *r, struct rb_node *node)
+{
+        unsigned long color = node->rb_parent_color & 3;
+
+        node->rb_parent_color = (unsigned long)reloc_ptr(r, rb_parent(node)) |
+                                color;
+        node->rb_left = reloc_ptr(r, node->rb_left);
+        node->rb_right = reloc_ptr(r, node->rb_right);
+}
+
+#endif
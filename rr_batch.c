@@ -0,0 +1,185 @@
+﻿#include <stdlib.h>
+#include "sim.h"
+
+/*
+ * 한 시간에 함께 도착한 job k개를 빈 CPU에서 Round Robin으로 수행하면
+ * 새 job이 끼어들지 않는 한 큐의 순서가 그대로 돌고, job i는
+ * r_i = ceil(a_i / q)번째 바퀴에서 끝난다 (a는 amount time, q는 퀀텀)
+ * 그 바퀴가 끝나기 전까지 job i가 기다린 시간은
+ *
+ *   - r_j < r_i인 job j: a_j 전부
+ *   - r_j >= r_i인 job j: 앞의 r_i - 1 바퀴 동안 (r_i - 1) q
+ *   - 큐에서 i보다 앞이고 r_j > r_i인 job j: r_i번째 바퀴의 q
+ *   - 큐에서 i보다 앞이고 r_j == r_i인 job j: 마지막 조각 a_j - (r_i - 1) q
+ *
+ * 이므로 r로 안정 정렬한 뒤 r이 같은 묶음마다 합을 구하고,
+ * 세 번째 항은 정렬하며 센 역순 쌍 수에 q를 곱해 구한다: O(k log k)
+ * response time은 큐 순서대로 min(a_j, q)의 누적합
+ */
+struct rr_batch_job {
+        int                             rounds;
+        sched_time_t                    amount_time;
+};
+
+/**
+* rr_batch_sort - rounds로 안정 병합 정렬하며 역순 쌍을 셈
+* @jobs: 정렬할 job들
+* @tmp: @jobs만큼의 임시 공간
+* @cnt: job 수
+*
+* 큐에서 앞에 있고 rounds가 더 큰 쌍의 수를 돌려줌
+*/
+static long long rr_batch_sort(struct rr_batch_job *jobs,
+                               struct rr_batch_job *tmp, const int cnt)
+{
+        long long inv = 0;
+
+        for (int width = 1; width < cnt; width *= 2) {
+                for (int lo = 0; lo < cnt; lo += 2 * width) {
+                        int mid = min(lo + width, cnt);
+                        int hi = min(lo + 2 * width, cnt);
+                        int l = lo, r = mid, k = lo;
+
+                        while (l < mid && r < hi) {
+                                if (jobs[r].rounds < jobs[l].rounds) {
+                                        inv += mid - l;
+                                        tmp[k++] = jobs[r++];
+                                } else {
+                                        tmp[k++] = jobs[l++];
+                                }
+                        }
+                        while (l < mid)
+                                tmp[k++] = jobs[l++];
+                        while (r < hi)
+                                tmp[k++] = jobs[r++];
+                }
+                for (int i = 0; i < cnt; i++)
+                        jobs[i] = tmp[i];
+        }
+
+        return inv;
+}
+
+/**
+* rr_batch_segment - 함께 도착한 job들의 turnaround, response time 합을 구함
+* @head: job 목록
+* @from: 묶음의 첫 job
+* @to: 묶음의 마지막 job 다음
+* @buf: 2 * (@to - @from)개의 임시 공간
+* @info: 시간 정보 기록 (누적)
+*
+* 합은 엔진처럼 sched_time_t의 범위에서 돌아가도록 64비트로 구한 뒤 자른다
+*/
+static void rr_batch_segment(const struct job_head *head, const int from,
+                             const int to, struct rr_batch_job *buf,
+                             struct time_info *info)
+{
+        const long long q = NR_RR_QUANTUM;
+        const int cnt = to - from;
+        struct rr_batch_job *jobs = buf, *tmp = buf + cnt;
+        long long tard = 0, resp = 0, wait = 0, less = 0;
+
+        for (int i = 0; i < cnt; i++) {
+                sched_time_t amount_time = job_head_amount(head, from + i);
+
+                jobs[i].amount_time = amount_time;
+                jobs[i].rounds = max((int)((amount_time + q - 1) / q), 1);
+                resp += wait;
+                wait += min(amount_time, q);
+        }
+
+        tard = q * rr_batch_sort(jobs, tmp, cnt);
+        for (int lo = 0, hi; lo < cnt; lo = hi) {
+                const long long done = (jobs[lo].rounds - 1) * q;
+                long long base = less + (cnt - lo) * done, last = 0;
+
+                for (hi = lo; hi < cnt && jobs[hi].rounds == jobs[lo].rounds;
+                     hi++) {
+                        last += jobs[hi].amount_time - done;
+                        tard += base + last;
+                        less += jobs[hi].amount_time;
+                }
+        }
+
+        info->tard_time = (sched_time_t)(unsigned int)
+                          ((unsigned int)info->tard_time + tard);
+        info->resp_time = (sched_time_t)(unsigned int)
+                          ((unsigned int)info->resp_time + resp);
+}
+
+/**
+* rr_batch_simulate - 겹치는 구간을 CPU가 빌 때까지만 엔진으로 수행
+* @head: job 목록
+* @from: 구간의 첫 job (빈 CPU에서 시작)
+* @to: 구간의 마지막 job 다음 (이때 CPU가 비어 있음)
+* @info: 시간 정보 기록 (누적)
+*/
+static void rr_batch_simulate(const struct job_head *head, const int from,
+                              const int to, struct time_info *info)
+{
+        struct job_head part = {
+                .jobs = head->jobs ? head->jobs + from : NULL,
+                .job_cnt = to - from,
+                .bursts = NULL,
+                .deadline = 0,
+                .arrived = head->arrived ? head->arrived + from : NULL,
+                .amount_time = head->amount_time ?
+                               head->amount_time + from : NULL
+        };
+        struct time_info ti;
+
+        ti = sim_simulate(&rr_sched_class, &part);
+        info->tard_time = (sched_time_t)(unsigned int)
+                          ((unsigned int)info->tard_time + ti.tard_time);
+        info->resp_time = (sched_time_t)(unsigned int)
+                          ((unsigned int)info->resp_time + ti.resp_time);
+}
+
+/**
+* get_rr_time_batch - 함께 도착하는 묶음은 바로 계산하는 Round Robin
+* @head: job 목록 (multi-burst와 deadline이 없어야 함)
+*
+* 같은 시간에 도착하는 job들을 묶음으로 보고, 묶음이 빈 CPU에서
+* 시작해 다음 도착 전에 모두 끝나면 위의 식으로 계산한다
+* 다음 job이 묶음이 끝나기 전에 도착하면 CPU가 다시 빌 때까지
+* (앞의 job이 모두 끝난 뒤에 도착하는 job까지)만 엔진으로 수행하고
+* 그 job부터 다시 묶음으로 본다
+*/
+struct time_info get_rr_time_batch(const struct job_head *head)
+{
+        const int jcnt = head->job_cnt;
+        struct time_info info = {
+                .tard_time = 0,
+                .resp_time = 0,
+                .miss_cnt = 0,
+                .late_time = 0
+        };
+        struct rr_batch_job *buf = NULL;
+        int cap = 0;
+
+        for (int i = 0, j; i < jcnt; i = j) {
+                const sched_time_t arrived = job_head_arrived(head, i);
+                long long end = arrived;
+
+                for (j = i; j < jcnt && job_head_arrived(head, j) == arrived;
+                     j++)
+                        end += job_head_amount(head, j);
+
+                if (j < jcnt && job_head_arrived(head, j) < end) {
+                        while (j < jcnt && job_head_arrived(head, j) < end)
+                                end += job_head_amount(head, j++);
+                        rr_batch_simulate(head, i, j, &info);
+                        continue;
+                }
+
+                if (j - i > cap) {
+                        free(buf);
+                        cap = max(j - i, 2 * cap);
+                        buf = malloc(2 * cap * sizeof(struct rr_batch_job));
+                }
+                rr_batch_segment(head, i, j, buf, &info);
+        }
+
+        free(buf);
+        return info;
+}
@@ -1,5 +1,5 @@
 ﻿#include <stdlib.h>
-#include "sched.h"
+#include "sim.h"
 
 /**
 * get_fcfs_time - First Come First Served 스케쥴링으로 수행된 job들의
@@ -7,21 +7,29 @@
 * @head: job 목록
 *
 * 모든 job을 차례대로 순회하며 시간을 누적하여 계산
+* I/O burst나 deadline이 있는 job 목록은 엔진으로 수행
 */
 struct time_info get_fcfs_time(const struct job_head *head)
 {
-        struct job_info *jobs = head->jobs;
         const int jcnt = head->job_cnt;
         struct time_info info = {
                 .tard_time = 0,
                 .resp_time = 0
         };
-        sched_time_t now = jobs->arrived;
+        sched_time_t now;
+
+        if (head->bursts || head->deadline)
+                return sim_simulate(&fcfs_sched_class, head);
+
+        now = job_head_arrived(head, 0);
 
         for (int i = 0; i < jcnt; i++) {
-                if ((jobs + i)->arrived > now)
-                        now = (jobs + i)->arrived;
-                now += sched_job(&info, now, jobs + i);
+                sched_time_t arrived = job_head_arrived(head, i);
+
+                if (arrived > now)
+                        now = arrived;
+                now += sched_job(&info, now, arrived,
+                                 job_head_amount(head, i));
         }
 
         return info;
@@ -30,35 +38,32 @@ struct time_info get_fcfs_time(const struct job_head *head)
 /**
 * sjf_push_wait_job - 새로 도착한 job을 대기 목록에 넣음
 * @root: 대기 목록 레드블랙트리의 루트
-* @job: 새로 도착한 job
-* @idx: job의 job 목록에서의 인덱스
+* @wjob: 새로 도착한 job
 *
-* 새로 도착한 job을 amount time과 인덱스 순의 비교로 레드블랙트리에 삽입
+* 새로 도착한 job을 CPU burst 길이와 대기 목록에 들어온 시간 순의 비교로
+* 레드블랙트리에 삽입, 둘 다 같으면 먼저 들어온 job이 왼쪽에 남는다
+* burst가 하나뿐인 job은 amount time과 arrival time으로 비교하는 것과 같다
 */
-void sjf_push_wait_job(struct rb_root *root, const struct job_info *job,
-                       const int idx)
+void sjf_push_wait_job(struct rb_root *root, struct wait_job *wjob)
 {
-        struct wait_job *new = malloc(sizeof(struct wait_job));
         struct rb_node **node = &(root->rb_node), *parent = NULL;
 
-        new->job = job;
-        new->idx = idx;
         while (*node) {
                 struct wait_job *this = container_of(*node, struct wait_job,
                                                      sjf_node);
                 parent = *node;
-                if (job->amount_time < this->job->amount_time)
+                if (wjob->burst < this->burst)
                         node = &((*node)->rb_left);
-                else if (job->amount_time > this->job->amount_time)
+                else if (wjob->burst > this->burst)
                         node = &((*node)->rb_right);
-                else if (job->arrived < this->job->arrived)
+                else if (wjob->ready < this->ready)
                         node = &((*node)->rb_left);
                 else
                         node = &((*node)->rb_right);
         }
 
-        rb_link_node(&new->sjf_node, parent, node);
-        rb_insert_color(&new->sjf_node, root);
+        rb_link_node(&wjob->sjf_node, parent, node);
+        rb_insert_color(&wjob->sjf_node, root);
 }
 
 /**
@@ -71,136 +76,145 @@ void sjf_push_wait_job(struct rb_root *root, const struct job_info *job,
 void sjf_pop_wait_job(struct wait_job *wjob, struct rb_root *root)
 {
         rb_erase(&wjob->sjf_node, root);
-        free(wjob);
-}
-
-#define sjf_pull_arrived_jobs(trav, job_cnt, now, jobs, wait_tree)      \
-        do {                                                            \
-                for (int i = (trav); i < (job_cnt); i++) {              \
-                        if (job_arrived((now), (jobs) + i)) {           \
-                                sjf_push_wait_job((wait_tree),          \
-                                                  (jobs) + i, i);       \
-                                (trav)++;                               \
-                        } else {                                        \
-                                break;                                  \
-                        }                                               \
-                }                                                       \
-        } while (0)
+}
+
+static void sjf_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        sjf_push_wait_job(&sim->rq_tree, wjob);
+}
+
+static struct wait_job *sjf_pick_next(struct sim *sim)
+{
+        struct wait_job *wjob;
+
+        if (RB_EMPTY_ROOT(&sim->rq_tree))
+                return NULL;
+
+        wjob = get_shortest_job(&sim->rq_tree);
+        sjf_pop_wait_job(wjob, &sim->rq_tree);
+        return wjob;
+}
+
+/* 비선점이므로 한 번 스케쥴 되면 끝날 때까지 수행 */
+static sched_time_t sjf_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        (void)sim;
+        return wjob->burst - wjob->run_time;
+}
+
+static void sjf_on_preempt(struct sim *sim, struct wait_job *wjob)
+{
+        sjf_push_wait_job(&sim->rq_tree, wjob);
+}
+
+/*
+ * Shortest Job First: amount time이 가장 짧은 job을 끝까지 수행
+ * 대기 목록은 레드블랙트리로 관리
+ */
+const struct sched_class sjf_sched_class = {
+        .name           = "sjf",
+        .enqueue        = sjf_enqueue,
+        .pick_next      = sjf_pick_next,
+        .on_tick        = sjf_on_tick,
+        .on_preempt     = sjf_on_preempt,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = 0
+};
 
 /**
 * get_sjf_time - Shortest Job First 스케쥴링으로 수행된 job들의
 *                총 turnaround time과 총 response time을 구함
 * @head: job 목록
 *
-* 모든 job을 차례대로 순회하며 시간을 누적하면서
 * 어떤 job이 끝난 시점을 포함한 이전 시간에 도착한
-* 도착한 job들을 레드블랙트리로 관리
+* job들을 레드블랙트리로 관리하며 시뮬레이션 엔진으로 수행
 */
 struct time_info get_sjf_time(const struct job_head *head)
 {
-        struct job_info *jobs = head->jobs;
-        const int jcnt = head->job_cnt;
-        struct time_info info = {
-                .tard_time = 0,
-                .resp_time = 0
-        };
-        sched_time_t now = jobs->arrived;
-
-        struct rb_root wait_tree = RB_ROOT;
-        struct wait_job *next_wjob;
-        int trav = 0;
-
-        do {
-                sjf_pull_arrived_jobs(trav, jcnt, now, jobs, &wait_tree);
-                if (RB_EMPTY_ROOT(&wait_tree)) {
-                        now = (jobs + trav)->arrived;
-                        continue;
-                }
-                next_wjob = get_shortest_job(&wait_tree);
-                now += sched_job(&info, now, next_wjob->job);
-                sjf_pop_wait_job(next_wjob, &wait_tree);
-        } while (!RB_EMPTY_ROOT(&wait_tree) || trav < jcnt);
-
-        return info;
+        return sim_simulate(&sjf_sched_class, head);
 }
 
 /**
-* rr_sched_job - Round Robin 스케쥴링 방식으로 job의 스케쥴링을 수행
-* @info: 시간 정보 기록 (response time)
-* @now: 현재 시간
+* rr_sched_job - Round Robin 스케쥴링 방식으로 이번에 수행할 시간을 구함
+* @quantum: 퀀텀
 * @wjob: 스케쥴 된 대기 중이던 job
 *
-* 처음 스케쥴 된 경우 response time을 계산
-* job의 남은 시간과 퀀텀 중에서 더 작은 시간만 수행
+* job의 현재 CPU burst의 남은 시간과 퀀텀 중에서 더 작은 시간만 수행
 */
-sched_time_t rr_sched_job(struct time_info *info, const sched_time_t now,
-                          struct wait_job *wjob)
+sched_time_t rr_sched_job(const sched_time_t quantum,
+                          const struct wait_job *wjob)
 {
-        sched_time_t rest_time = wjob->job->amount_time - wjob->run_time;
-        sched_time_t perf_time = min(rest_time, NR_RR_QUANTUM);
-
-        if (first_sched(wjob))
-                info->resp_time += now - wjob->job->arrived;
+        sched_time_t rest_time = wjob->burst - wjob->run_time;
 
-        wjob->run_time += perf_time;
-        return perf_time;
+        return min(rest_time, quantum);
 }
 
 /**
-* rr_push_wait_job - 새로 도착한 job을 대기 목록 큐에 넣음
+* rr_push_wait_job - 새로 도착했거나 아직 끝나지 않은 job을 대기 목록 큐에 넣음
 * @rq: 대기 목록 큐
-* @job: 새로 도착한 job
+* @wjob: 대기 목록에 넣을 job
 *
-* 새로 도착한 job을 리스트의 tail에 삽입
+* job을 리스트의 tail에 삽입
 */
-void rr_push_wait_job(struct list_head *rq, struct job_info *job)
+void rr_push_wait_job(struct list_head *rq, struct wait_job *wjob)
 {
-        struct wait_job *new = malloc(sizeof(struct wait_job));
-
-        new->job = job;
-        new->run_time = 0;
-        list_add_tail(&new->rr_list, rq);
+        list_add_tail(&wjob->rr_list, rq);
 }
 
 /**
-* rr_repush_wait_job - 아직 끝나지 않은 job을 다시 대기 큐에 넣음
-* @rq: 대기 목록 큐
-*
-* 현재 head인 노드를 tail로 바꿔준다
-* 반드시 하나 이상의 job이 대기 상태에 있어야 함
+* rr_pop_wait_job - 스케쥴 된 대기 중이던 job을 대기 목록 큐에서 삭제
+* @wjob: 스케쥴 된 대기 중이던 job
 */
-void rr_repush_wait_job(struct list_head *rq)
+void rr_pop_wait_job(struct wait_job *wjob)
 {
-        list_rotate_left(rq);
+        list_del(&wjob->rr_list);
 }
 
-/**
-* rr_pop_wait_job - 스케쥴 된 대기 중이던 job을 대기 목록에서 삭제
-* @wjob: 스케쥴 된 대기 중이던 job
-* @info: 시간 정보 기록 (turnaround time)
-* @now: 현재 시간
-*
-* 대기 목록 큐에서 job을 삭제 및 turnaround time 계산
-*/
-void rr_pop_wait_job(struct wait_job *wjob, struct time_info *info,
-                     const sched_time_t now)
+static void rr_enqueue(struct sim *sim, struct wait_job *wjob)
 {
-        list_del(&wjob->rr_list);
-        info->tard_time += now - wjob->job->arrived;
-        free(wjob);
-}
-
-#define rr_pull_arrived_jobs(trav, job_cnt, now, jobs, rq)              \
-        do {                                                            \
-                for (int i = (trav); i < (jcnt); i++) {                 \
-                        if (job_arrived((now), (jobs)+i)) {             \
-                                rr_push_wait_job(rq, (jobs)+i);         \
-                                (trav)++;                               \
-                        } else {                                        \
-                                break;                                  \
-                        }                                               \
-                }                                                       \
-        } while (0)
+        rr_push_wait_job(&sim->rq_list, wjob);
+}
+
+static struct wait_job *rr_pick_next(struct sim *sim)
+{
+        struct wait_job *wjob;
+
+        if (list_empty(&sim->rq_list))
+                return NULL;
+
+        wjob = get_rr_next(&sim->rq_list);
+        rr_pop_wait_job(wjob);
+        return wjob;
+}
+
+static sched_time_t rr_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        return rr_sched_job(sim->quantum, wjob);
+}
+
+/*
+ * 퀀텀 동안 도착한 job들이 먼저 큐에 들어간 뒤에
+ * 끝나지 않은 job이 tail로 돌아간다
+ */
+static void rr_on_preempt(struct sim *sim, struct wait_job *wjob)
+{
+        rr_push_wait_job(&sim->rq_list, wjob);
+}
+
+/*
+ * Round Robin: 대기 목록 큐의 head부터 퀀텀만큼씩 돌아가며 수행
+ */
+const struct sched_class rr_sched_class = {
+        .name           = "rr",
+        .enqueue        = rr_enqueue,
+        .pick_next      = rr_pick_next,
+        .on_tick        = rr_on_tick,
+        .on_preempt     = rr_on_preempt,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = 0
+};
 
 /**
 * get_rr_time - Round Robin 스케쥴링으로 수행된 job들의
@@ -208,37 +222,287 @@ void rr_pop_wait_job(struct wait_job *wjob, struct time_info *info,
 * @head: job 목록
 *
 * 기본적인 Round Robin 스케쥴 방식의 알고리즘에 의거
+* 한 번에 도착하는 job 묶음은 get_rr_time_batch가 시뮬레이션 없이 계산
 */
 struct time_info get_rr_time(const struct job_head *head)
 {
-        struct job_info *jobs = head->jobs;
-        const int jcnt = head->job_cnt;
-        struct time_info info = {
-                .tard_time = 0,
-                .resp_time = 0
-        };
+        if (head->bursts || head->deadline)
+                return sim_simulate(&rr_sched_class, head);
+
+        return get_rr_time_batch(head);
+}
 
-        LIST_HEAD(rr_queue);
-        struct wait_job *next_wjob;
-        sched_time_t now = jobs->arrived;
-        int trav = 0;
+/* FCFS는 도착 순서대로 대기 목록 큐에 넣고 끝날 때까지 수행 */
+static sched_time_t fcfs_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        (void)sim;
+        return wjob->burst - wjob->run_time;
+}
 
-        do {
-                if (list_empty(&rr_queue)) {
-                        now = (jobs + trav)->arrived;
-                        rr_pull_arrived_jobs(trav, jcnt, now, jobs, &rr_queue);
-                        continue;
-                }
+/*
+ * First Come First Served: get_fcfs_time은 대기 목록 없이 바로 계산하고
+ * 이 정책은 엔진 위에서 다른 정책과 같은 방식으로 돌릴 때 쓴다
+ */
+const struct sched_class fcfs_sched_class = {
+        .name           = "fcfs",
+        .enqueue        = rr_enqueue,
+        .pick_next      = rr_pick_next,
+        .on_tick        = fcfs_on_tick,
+        .on_preempt     = rr_enqueue,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = 0
+};
 
-                next_wjob = get_rr_next(&rr_queue);
-                now += rr_sched_job(&info, now, next_wjob);
-                rr_pull_arrived_jobs(trav, jcnt, now, jobs, &rr_queue);
+/**
+* edf_push_wait_job - job을 절대 deadline 순으로 대기 목록에 넣음
+* @root: 대기 목록 레드블랙트리의 루트
+* @wjob: 대기 목록에 넣을 job
+*
+* deadline이 같으면 대기 목록에 먼저 들어온 job이 왼쪽에 남는다
+*/
+static void edf_push_wait_job(struct rb_root *root, struct wait_job *wjob)
+{
+        struct rb_node **node = &(root->rb_node), *parent = NULL;
+        sched_time_t deadline = job_deadline(wjob);
 
-                if (job_done(next_wjob))
-                        rr_pop_wait_job(next_wjob, &info, now);
+        while (*node) {
+                struct wait_job *this = container_of(*node, struct wait_job,
+                                                     sjf_node);
+                sched_time_t this_deadline = job_deadline(this);
+
+                parent = *node;
+                if (deadline < this_deadline)
+                        node = &((*node)->rb_left);
+                else if (deadline > this_deadline)
+                        node = &((*node)->rb_right);
+                else if (wjob->ready < this->ready)
+                        node = &((*node)->rb_left);
                 else
-                        rr_repush_wait_job(&rr_queue);
-        } while (!list_empty(&rr_queue) || trav < jcnt);
+                        node = &((*node)->rb_right);
+        }
 
-        return info;
-}
\ No newline at end of file
+        rb_link_node(&wjob->sjf_node, parent, node);
+        rb_insert_color(&wjob->sjf_node, root);
+}
+
+static void edf_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        edf_push_wait_job(&sim->rq_tree, wjob);
+}
+
+/*
+ * 다음 이벤트까지만 수행되므로 새로 도착한 job의 deadline이 더 빠르면
+ * 다음 pick_next에서 그 job이 선택된다
+ */
+static sched_time_t edf_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        (void)sim;
+        return wjob->burst - wjob->run_time;
+}
+
+/*
+ * Earliest Deadline First: 절대 deadline이 가장 빠른 job을 수행
+ * 대기 목록은 레드블랙트리로 관리하고 arrival (또는 I/O 완료) 이벤트에서만
+ * 선점이 일어나므로 job 하나당 O(log n)
+ */
+const struct sched_class edf_sched_class = {
+        .name           = "edf",
+        .enqueue        = edf_enqueue,
+        .pick_next      = sjf_pick_next,
+        .on_tick        = edf_on_tick,
+        .on_preempt     = edf_enqueue,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = SCHED_PREEMPT_ARRIVAL
+};
+
+/**
+* get_edf_time - Earliest Deadline First 스케쥴링으로 수행된 job들의
+*                총 turnaround time, 총 response time과
+*                deadline을 넘긴 job 수, 총 tardiness를 구함
+* @head: job 목록
+*/
+struct time_info get_edf_time(const struct job_head *head)
+{
+        return sim_simulate(&edf_sched_class, head);
+}
+
+static inline void prio_set_slot(struct prio_array *array, const int slot)
+{
+        if (!(array->bitmap & (1ULL << slot))) {
+                INIT_LIST_HEAD(&array->queue[slot]);
+                array->bitmap |= 1ULL << slot;
+        }
+}
+
+/**
+* prio_move_slot - 한 큐의 job들을 다른 큐의 앞에 이어 붙임
+* @array: 우선순위 대기 목록
+* @from: 옮길 큐
+* @to: 받을 큐
+*
+* 먼저 0단계에 올라와 있던 job들이 앞에 남는다
+*/
+static inline void prio_move_slot(struct prio_array *array, const int from,
+                                  const int to)
+{
+        if (from == to || !(array->bitmap & (1ULL << from)))
+                return;
+
+        prio_set_slot(array, to);
+        list_splice(&array->queue[from], &array->queue[to]);
+        array->bitmap &= ~(1ULL << from);
+}
+
+/**
+* prio_age - 현재 시간의 epoch까지 aging을 반영
+* @array: 우선순위 대기 목록
+* @now: 현재 시간
+*
+* epoch 하나마다 0단계 큐를 새 0단계 큐 앞에 붙이기만 하면 되고
+* NR_PRIO번 이상 오르면 모든 큐가 0단계로 모이므로 그 뒤로는
+* 0단계 큐를 한 번에 옮긴다
+*/
+static void prio_age(struct prio_array *array, const sched_time_t now)
+{
+        int epoch = prio_epoch(now);
+        int steps = epoch - array->epoch;
+
+        if (steps <= 0)
+                return;
+        if (!array->bitmap) {
+                array->epoch = epoch;
+                return;
+        }
+
+        for (int k = 0; k < min(steps, NR_PRIO); k++) {
+                prio_move_slot(array, array->epoch & (NR_PRIO - 1),
+                               (array->epoch + 1) & (NR_PRIO - 1));
+                array->epoch++;
+        }
+        if (array->epoch != epoch) {
+                prio_move_slot(array, array->epoch & (NR_PRIO - 1),
+                               epoch & (NR_PRIO - 1));
+                array->epoch = epoch;
+        }
+}
+
+/**
+* prio_slot - 우선순위 @prio인 job이 지금 들어갈 큐를 구함
+* @array: 우선순위 대기 목록
+* @prio: job의 우선순위
+*/
+static inline int prio_slot(const struct prio_array *array, int prio)
+{
+        prio = min(max(prio, 0), NR_PRIO - 1);
+        return (array->epoch + prio) & (NR_PRIO - 1);
+}
+
+static void prio_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        struct prio_array *array = &sim->rq_prio;
+        int slot;
+
+        prio_age(array, sim->now);
+        slot = prio_slot(array, wjob->job->prio);
+        prio_set_slot(array, slot);
+        list_add_tail(&wjob->rr_list, &array->queue[slot]);
+}
+
+/*
+ * 선점된 job은 자기 우선순위 큐의 맨 앞에서 다시 기다린다
+ */
+static void prio_requeue(struct sim *sim, struct wait_job *wjob)
+{
+        struct prio_array *array = &sim->rq_prio;
+        int slot;
+
+        prio_age(array, sim->now);
+        slot = prio_slot(array, wjob->job->prio);
+        prio_set_slot(array, slot);
+        list_add(&wjob->rr_list, &array->queue[slot]);
+}
+
+/*
+ * 비트맵을 현재 epoch만큼 돌리면 가장 낮은 켜진 비트가
+ * 가장 높은 우선순위 큐이다
+ */
+static struct wait_job *prio_pick_next(struct sim *sim)
+{
+        struct prio_array *array = &sim->rq_prio;
+        unsigned long long rot;
+        struct wait_job *wjob;
+        int shift, slot;
+
+        prio_age(array, sim->now);
+        if (!array->bitmap)
+                return NULL;
+
+        shift = array->epoch & (NR_PRIO - 1);
+        rot = (array->bitmap >> shift) |
+              (array->bitmap << ((NR_PRIO - shift) & (NR_PRIO - 1)));
+        slot = (array->epoch + find_first_bit64(rot)) & (NR_PRIO - 1);
+
+        wjob = container_of(array->queue[slot].next, struct wait_job,
+                            rr_list);
+        list_del(&wjob->rr_list);
+        if (list_empty(&array->queue[slot]))
+                array->bitmap &= ~(1ULL << slot);
+        return wjob;
+}
+
+static sched_time_t prio_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        (void)sim;
+        return wjob->burst - wjob->run_time;
+}
+
+/*
+ * 비선점 우선순위: 가장 높은 우선순위의 job을 CPU burst가 끝날 때까지 수행
+ */
+const struct sched_class prio_sched_class = {
+        .name           = "prio",
+        .enqueue        = prio_enqueue,
+        .pick_next      = prio_pick_next,
+        .on_tick        = prio_on_tick,
+        .on_preempt     = prio_requeue,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = 0
+};
+
+/*
+ * 선점 우선순위: arrival (또는 I/O 완료) 이벤트마다 다시 골라
+ * 더 높은 우선순위의 job이 들어왔으면 그 job을 수행
+ */
+const struct sched_class prio_preempt_sched_class = {
+        .name           = "prio-preempt",
+        .enqueue        = prio_enqueue,
+        .pick_next      = prio_pick_next,
+        .on_tick        = prio_on_tick,
+        .on_preempt     = prio_requeue,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = SCHED_PREEMPT_ARRIVAL
+};
+
+/**
+* get_prio_time - 비선점 우선순위 스케쥴링으로 수행된 job들의
+*                 총 turnaround time과 총 response time을 구함
+* @head: job 목록
+*/
+struct time_info get_prio_time(const struct job_head *head)
+{
+        return sim_simulate(&prio_sched_class, head);
+}
+
+/**
+* get_prio_preempt_time - 선점 우선순위 스케쥴링으로 수행된 job들의
+*                         총 turnaround time과 총 response time을 구함
+* @head: job 목록
+*/
+struct time_info get_prio_preempt_time(const struct job_head *head)
+{
+        return sim_simulate(&prio_preempt_sched_class, head);
+}
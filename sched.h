@@ -4,66 +4,300 @@
 #include "rbtree.h"
 #include "list.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 typedef int                     sched_time_t;
 
+#define SCHED_TIME_MAX          0x7fffffff
+#define SCHED_TIME_MIN          (-SCHED_TIME_MAX - 1)
+
+#ifndef min
+#define min(a, b)       (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b)       (((a) > (b)) ? (a) : (b))
+#endif
+
+/**
+* find_first_bit64 - 64비트 값에서 켜진 가장 낮은 비트의 위치를 구함
+* @word: 0이 아닌 값
+*/
+static inline int find_first_bit64(const unsigned long long word)
+{
+#ifdef _MSC_VER
+        unsigned long idx;
+
+        _BitScanForward64(&idx, word);
+        return (int)idx;
+#else
+        return __builtin_ctzll(word);
+#endif
+}
+
+struct burst_pool;
+
+/*
+ * @bursts가 NULL이면 모든 job은 amount_time 길이의 CPU burst 하나로 끝난다
+ * @deadline이 0이면 job_info의 deadline은 쓰지 않는다
+ * @arrived가 NULL이 아니면 SoA 목록으로, arrival time과 amount time은
+ * @arrived와 @amount_time 열에서 읽고 job_info의 두 값은 쓰지 않는다
+ * 이때 @jobs는 나머지 열 (deadline, prio, ...)이 있을 때만 두고
+ * NULL이면 나머지 열은 모두 0으로 본다
+ */
 struct job_head {
         struct job_info                 *jobs;
         int                             job_cnt;
+        struct burst_pool               *bursts;
+        int                             deadline;
+        sched_time_t                    *arrived;
+        sched_time_t                    *amount_time;
 };
 
+/*
+ * deadline은 arrival time 기준의 상대 deadline이며 0이면 deadline이 없음
+ * prio는 우선순위 스케쥴링의 우선순위로 작을수록 먼저 수행
+ * tickets는 비례 배분 스케쥴링 (stride, lottery)의 티켓 수, 0이면 1로 본다
+ * group은 fair-share 스케쥴링에서 job이 속한 그룹 (사용자) 번호
+ */
 struct job_info {
         sched_time_t                    arrived;
         sched_time_t                    amount_time;
+        sched_time_t                    deadline;
+        int                             prio;
+        int                             tickets;
+        int                             group;
+};
+
+/**
+* job_head_arrived - job 목록에서 @i번째 job의 arrival time을 구함
+* @head: job 목록 (AoS 또는 SoA)
+* @i: job의 인덱스
+*/
+static inline sched_time_t job_head_arrived(const struct job_head *head,
+                                            const int i)
+{
+        return head->arrived ? head->arrived[i] : (head->jobs + i)->arrived;
+}
+
+/**
+* job_head_amount - job 목록에서 @i번째 job의 amount time을 구함
+* @head: job 목록 (AoS 또는 SoA)
+* @i: job의 인덱스
+*/
+static inline sched_time_t job_head_amount(const struct job_head *head,
+                                           const int i)
+{
+        return head->amount_time ? head->amount_time[i] :
+                                   (head->jobs + i)->amount_time;
+}
+
+/*
+ * struct job_cols - SoA job 목록의 arrival time, amount time 열
+ *
+ * 두 열은 캐시 라인 (JOB_COLS_ALIGN) 경계에서 시작하고,
+ * 합쳐서 JOB_COLS_HUGE_MIN 이상이면 huge page로 받아 큰 목록을
+ * 훑을 때의 TLB miss를 줄인다 (리눅스에서 MAP_HUGETLB를 먼저
+ * 시도하고, 안 되면 transparent huge page를 권고한다)
+ * @huge는 열을 mmap으로 받았는지를 기록한다
+ */
+#define JOB_COLS_ALIGN          64
+#define JOB_COLS_HUGE_MIN       (1 << 21)
+
+struct job_cols {
+        sched_time_t                    *arrived;
+        sched_time_t                    *amount_time;
+        int                             cap;
+        int                             huge;
+        size_t                          size;
 };
 
+extern void job_cols_init(struct job_cols *cols);
+extern void job_cols_reserve(struct job_cols *cols, const int cnt);
+extern void job_cols_free(struct job_cols *cols);
+
+/*
+ * miss_cnt와 late_time은 deadline이 있는 job 목록에서만 계산되며
+ * late_time은 deadline을 넘긴 시간(tardiness)의 합
+ */
 struct time_info {
         sched_time_t                    tard_time;
         sched_time_t                    resp_time;
+        int                             miss_cnt;
+        sched_time_t                    late_time;
 };
 
+/*
+ * struct burst_pool - CPU burst와 I/O burst가 번갈아 나오는 job들의 burst 목록
+ *
+ * 모든 job의 burst를 하나의 배열 times에 이어 붙여 저장한다
+ * job i의 burst는 times[first[i]]부터 times[first[i + 1] - 1]까지이며
+ * CPU, I/O, CPU, ..., CPU 순서로 CPU burst로 시작하고 끝난다
+ * job의 amount_time은 CPU burst의 합
+ */
+struct burst_pool {
+        sched_time_t                    *times;
+        int                             *first;
+        int                             nr;
+        int                             cap;
+        int                             job_cnt;
+        int                             job_cap;
+};
+
+extern void burst_pool_init(struct burst_pool *pool);
+extern void burst_pool_free(struct burst_pool *pool);
+extern void burst_pool_reset(struct burst_pool *pool);
+extern void burst_pool_push(struct burst_pool *pool, const sched_time_t time);
+extern void burst_pool_end_job(struct burst_pool *pool);
+
+/**
+* burst_of - job의 @nr번째 burst를 구함
+* @pool: burst 목록
+* @idx: job의 job 목록에서의 인덱스
+* @nr: job 안에서 burst의 순서 (짝수는 CPU, 홀수는 I/O)
+*/
+static inline sched_time_t burst_of(const struct burst_pool *pool,
+                                    const int idx, const int nr)
+{
+        return pool->times[pool->first[idx] + nr];
+}
+
+/**
+* nr_bursts_of - job의 burst 수를 구함
+* @pool: burst 목록
+* @idx: job의 job 목록에서의 인덱스
+*/
+static inline int nr_bursts_of(const struct burst_pool *pool, const int idx)
+{
+        return pool->first[idx + 1] - pool->first[idx];
+}
+
 extern struct time_info get_fcfs_time(const struct job_head *head);
 extern struct time_info get_sjf_time(const struct job_head *head);
 extern struct time_info get_rr_time(const struct job_head *head);
+extern struct time_info get_edf_time(const struct job_head *head);
+extern struct time_info get_prio_time(const struct job_head *head);
+extern struct time_info get_prio_preempt_time(const struct job_head *head);
+extern struct time_info get_stride_time(const struct job_head *head);
+extern struct time_info get_lottery_time(const struct job_head *head);
+extern struct time_info get_fair_time(const struct job_head *head,
+                                      struct time_info *groups,
+                                      const int nr_groups);
+
+/*
+ * FCFS 배치 계산에서 한 번에 처리하는 케이스 수 (SIMD lane 수)
+ * lane 하나가 sched_time_t 하나이므로 벡터 폭에 따라 정해진다
+ */
+#if defined(__AVX512F__)
+#define NR_FCFS_LANES   16
+#elif defined(__AVX2__)
+#define NR_FCFS_LANES   8
+#else
+#define NR_FCFS_LANES   4
+#endif
+
+/*
+ * struct fcfs_batch - 여러 케이스의 job 목록을 lane 별로 펼친 SoA 배치
+ *
+ * i번째 job들은 arrived[i * NR_FCFS_LANES + lane]에 모여 있어
+ * 한 번의 벡터 load로 모든 lane의 i번째 job을 읽는다
+ * job이 모자란 lane의 빈 칸은 0으로 채우고 job_cnt로 마스킹한다
+ */
+struct fcfs_batch {
+        sched_time_t                    *arrived;
+        sched_time_t                    *amount_time;
+        int                             job_cnt[NR_FCFS_LANES];
+        int                             max_cnt;
+        int                             cap;
+};
+
+extern void fcfs_batch_load(struct fcfs_batch *batch,
+                            const struct job_head *heads, const int cnt);
+extern void fcfs_batch_free(struct fcfs_batch *batch);
+extern void get_fcfs_time_batch(const struct fcfs_batch *batch,
+                                struct time_info *info);
+extern void get_fcfs_times(const struct job_head *heads, const int cnt,
+                           struct time_info *info);
+
+/* 스레드 하나가 맡을 최소 job 수, 이보다 작으면 나눠도 이득이 없음 */
+#define NR_FCFS_PAR_MIN (1 << 16)
+
+extern struct time_info get_fcfs_time_par(const struct job_head *head,
+                                          const int nr_threads);
+extern struct time_info get_rr_time_batch(const struct job_head *head);
 
 /**
 * sched_job - FCFS 스케쥴링과 SJF 스케쥴링에서 job의 스케쥴링을 수행
 * @info: 시간 정보 기록 (response time)
 * @now: 현재 시간
-* @job: 스케쥴 된job
+* @arrived: 스케쥴 된 job의 arrival time
+* @amount_time: 스케쥴 된 job의 amount time
 *
 * response time과 turnaround time을 계산
 */
 static inline sched_time_t sched_job(struct time_info *info,
                                      const sched_time_t now,
-                                     const struct job_info *job)
+                                     const sched_time_t arrived,
+                                     const sched_time_t amount_time)
 {
-        sched_time_t resp_time = now - job->arrived;
+        sched_time_t resp_time = now - arrived;
 
         info->resp_time += resp_time;
-        info->tard_time += resp_time + job->amount_time;
+        info->tard_time += resp_time + amount_time;
 
-        return job->amount_time;
+        return amount_time;
 }
 
+/*
+ * run_time은 현재 CPU burst에서 수행한 시간이고 burst는 그 burst의 길이
+ * ready는 job이 마지막으로 대기 목록에 들어온 시간
+ * (처음에는 arrival time, 이후에는 I/O가 끝난 시간)
+ * pass는 stride 스케쥴링의 pass 값
+ * arrived는 job의 arrival time (SoA 목록에서는 job_info에 없으므로 복사해 둠)
+ */
 struct wait_job {
         const struct job_info           *job;
+        sched_time_t                    arrived;
 
         struct rb_node                  sjf_node;
         int                             idx;
 
         struct list_head                rr_list;
         sched_time_t                    run_time;
+
+        sched_time_t                    burst;
+        sched_time_t                    ready;
+        int                             burst_nr;
+
+        unsigned long long              pass;
 };
 
 /**
-* job_arrived - 현재 job이 도착한 상태인지 확인
+* job_deadline - job의 절대 deadline을 구함
+* @wjob: 대기 중인 job
+*
+* deadline이 없는 job은 가장 늦은 deadline을 가진 것으로 본다
+* 도착 시간에 deadline을 더해 sched_time_t를 넘으면 가장 늦은 deadline으로
+* 자른다 (넘친 값은 음수가 되어 가장 급한 job이 된다)
+*/
+static inline sched_time_t job_deadline(const struct wait_job *wjob)
+{
+        long long deadline;
+
+        if (!wjob->job->deadline)
+                return SCHED_TIME_MAX;
+        deadline = (long long)wjob->arrived + wjob->job->deadline;
+        return (sched_time_t)min(deadline, SCHED_TIME_MAX);
+}
+
+/**
+* job_tickets - job의 티켓 수를 구함
 * @job: job의 정보
-* @now: 현재 시간
 */
-static inline int job_arrived(const sched_time_t now,
-                              const struct job_info *job)
+static inline int job_tickets(const struct job_info *job)
 {
-        return job->arrived <= now;
+        return job->tickets > 0 ? job->tickets : 1;
 }
 
 /**
@@ -77,8 +311,7 @@ static inline struct wait_job *get_shortest_job(struct rb_root *root)
         return container_of(rb_first(root), struct wait_job, sjf_node);
 }
 
-extern void sjf_push_wait_job(struct rb_root *root, const struct job_info *job,
-                              const int idx);
+extern void sjf_push_wait_job(struct rb_root *root, struct wait_job *wjob);
 extern void sjf_pop_wait_job(struct wait_job *wjob, struct rb_root *root);
 
 #define NR_RR_QUANTUM   4
@@ -100,24 +333,21 @@ static inline struct wait_job *get_rr_next(const struct list_head *rq)
 */
 static inline int first_sched(const struct wait_job *wjob)
 {
-        return wjob->run_time == 0;
+        return wjob->burst_nr == 0 && wjob->run_time == 0;
 }
 
 /**
-* job_done - job이 끝났는지 확인
+* job_done - job의 현재 CPU burst가 끝났는지 확인
 * @wjob: 스케쥴 된 대기 중이던 job
 */
 static inline int job_done(const struct wait_job *wjob)
 {
-        return wjob->run_time == wjob->job->amount_time;
+        return wjob->run_time == wjob->burst;
 }
 
-extern sched_time_t rr_sched_job(struct time_info *info,
-                                 const sched_time_t now,
-                                 struct wait_job *wjob);
-extern void rr_push_wait_job(struct list_head *rq, struct job_info *job);
-extern void rr_repush_wait_job(struct list_head *rq);
-extern void rr_pop_wait_job(struct wait_job *wjob, struct time_info *info,
-                            const sched_time_t now);
+extern sched_time_t rr_sched_job(const sched_time_t quantum,
+                                 const struct wait_job *wjob);
+extern void rr_push_wait_job(struct list_head *rq, struct wait_job *wjob);
+extern void rr_pop_wait_job(struct wait_job *wjob);
 
 #endif
\ No newline at end of file
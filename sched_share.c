@@ -0,0 +1,493 @@
+﻿#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+/*
+ * 비례 배분 스케쥴링
+ * job은 티켓 수에 비례하는 만큼 CPU를 받고 한 번에 퀀텀 하나씩 수행된다
+ */
+
+/**
+* job_stride - 티켓 수에 반비례하는 stride를 구함
+* @job: job의 정보
+*/
+static inline unsigned long long job_stride(const struct job_info *job)
+{
+        return STRIDE1 / job_tickets(job);
+}
+
+/**
+* stride_push_wait_job - job을 pass 순으로 대기 목록에 넣음
+* @root: 대기 목록 레드블랙트리의 루트
+* @wjob: 대기 목록에 넣을 job
+*
+* pass가 같으면 대기 목록에 먼저 들어온 job이 왼쪽에 남는다
+*/
+static void stride_push_wait_job(struct rb_root *root, struct wait_job *wjob)
+{
+        struct rb_node **node = &(root->rb_node), *parent = NULL;
+
+        while (*node) {
+                struct wait_job *this = container_of(*node, struct wait_job,
+                                                     sjf_node);
+                parent = *node;
+                if (wjob->pass < this->pass)
+                        node = &((*node)->rb_left);
+                else if (wjob->pass > this->pass)
+                        node = &((*node)->rb_right);
+                else if (wjob->ready < this->ready)
+                        node = &((*node)->rb_left);
+                else
+                        node = &((*node)->rb_right);
+        }
+
+        rb_link_node(&wjob->sjf_node, parent, node);
+        rb_insert_color(&wjob->sjf_node, root);
+}
+
+/*
+ * 새로 도착했거나 I/O에서 돌아온 job은 전역 pass보다 뒤처져 있으면
+ * 전역 pass에서 시작하므로 쉬는 동안 몫을 쌓아 두지 못한다
+ */
+static void stride_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        wjob->pass = max(wjob->pass, sim->vtime);
+        stride_push_wait_job(&sim->rq_tree, wjob);
+}
+
+static struct wait_job *stride_pick_next(struct sim *sim)
+{
+        struct wait_job *wjob;
+
+        if (RB_EMPTY_ROOT(&sim->rq_tree))
+                return NULL;
+
+        wjob = container_of(rb_first(&sim->rq_tree), struct wait_job,
+                            sjf_node);
+        rb_erase(&wjob->sjf_node, &sim->rq_tree);
+        sim->vtime = wjob->pass;
+        return wjob;
+}
+
+static sched_time_t share_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        return min(wjob->burst - wjob->run_time, sim->quantum);
+}
+
+/* 퀀텀 하나를 다 쓴 job은 stride만큼 pass가 늘어난다 */
+static void stride_on_preempt(struct sim *sim, struct wait_job *wjob)
+{
+        wjob->pass += job_stride(wjob->job);
+        stride_push_wait_job(&sim->rq_tree, wjob);
+}
+
+/*
+ * Stride: pass가 가장 작은 job을 퀀텀만큼 수행
+ * 대기 목록은 pass를 키로 하는 레드블랙트리
+ */
+const struct sched_class stride_sched_class = {
+        .name           = "stride",
+        .enqueue        = stride_enqueue,
+        .pick_next      = stride_pick_next,
+        .on_tick        = share_on_tick,
+        .on_preempt     = stride_on_preempt,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .flags          = 0
+};
+
+/**
+* get_stride_time - Stride 스케쥴링으로 수행된 job들의
+*                   총 turnaround time과 총 response time을 구함
+* @head: job 목록
+*/
+struct time_info get_stride_time(const struct job_head *head)
+{
+        return sim_simulate(&stride_sched_class, head);
+}
+
+/*
+ * struct lottery - 대기 중인 job들의 티켓 수를 담은 Fenwick tree
+ *
+ * job 목록의 인덱스마다 칸 하나를 두고 대기 중이면 티켓 수,
+ * 아니면 0을 넣는다. 추첨한 번호가 들어가는 칸은 트리를 위에서부터
+ * 내려가며 찾으므로 추첨과 갱신 모두 O(log n)
+ * sim_feed로 나중에 들어온 job은 칸이 모자라면 트리를 두 배씩 늘린다
+ */
+struct lottery {
+        unsigned long long              *tree;
+        struct wait_job                 **slot;
+        int                             n;
+        int                             top;
+        unsigned long long              total;
+        unsigned long long              rnd;
+};
+
+static void lottery_init(struct sim *sim)
+{
+        struct lottery *lot = malloc(sizeof(struct lottery));
+
+        lot->n = sim->job_cnt;
+        lot->tree = calloc(lot->n + 1, sizeof(unsigned long long));
+        lot->slot = malloc(max(lot->n, 1) * sizeof(struct wait_job *));
+        for (lot->top = 1; lot->top * 2 <= lot->n; lot->top *= 2)
+                ;
+        lot->total = 0;
+        lot->rnd = LOTTERY_SEED;
+        sim->priv = lot;
+}
+
+static void lottery_exit(struct sim *sim)
+{
+        struct lottery *lot = sim->priv;
+
+        free(lot->tree);
+        free(lot->slot);
+        free(lot);
+        sim->priv = NULL;
+}
+
+static void lottery_fork(struct sim *dst, const struct sim *src,
+                         struct reloc *r)
+{
+        const struct lottery *from = src->priv;
+        struct lottery *lot = malloc(sizeof(struct lottery));
+
+        *lot = *from;
+        lot->tree = malloc((lot->n + 1) * sizeof(unsigned long long));
+        memcpy(lot->tree, from->tree,
+               (lot->n + 1) * sizeof(unsigned long long));
+        lot->slot = malloc(max(lot->n, 1) * sizeof(struct wait_job *));
+        for (int i = 0; i < lot->n; i++)
+                lot->slot[i] = reloc_ptr(r, from->slot[i]);
+        dst->priv = lot;
+}
+
+static inline void lottery_add(struct lottery *lot, int idx,
+                               const unsigned long long delta)
+{
+        for (idx++; idx <= lot->n; idx += idx & -idx)
+                lot->tree[idx] += delta;
+        lot->total += delta;
+}
+
+/**
+* lottery_grow - @idx번째 칸이 들어가도록 트리를 늘림
+* @lot: 티켓 트리
+* @idx: 새로 쓸 칸
+*
+* 트리를 칸마다의 티켓 수로 되돌린 뒤 늘린 크기로 다시 쌓는다: O(n)
+* 칸은 job 인덱스 순으로 늘어나므로 두 배씩 늘리면 job 하나에 O(1)
+*/
+static void lottery_grow(struct lottery *lot, const int idx)
+{
+        const int n = max(idx + 1, 2 * lot->n);
+
+        for (int i = lot->n; i >= 1; i--)
+                if (i + (i & -i) <= lot->n)
+                        lot->tree[i + (i & -i)] -= lot->tree[i];
+
+        lot->tree = realloc(lot->tree, (n + 1) * sizeof(unsigned long long));
+        memset(lot->tree + lot->n + 1, 0,
+               (n - lot->n) * sizeof(unsigned long long));
+        lot->slot = realloc(lot->slot, n * sizeof(struct wait_job *));
+        lot->n = n;
+        for (int i = 1; i <= n; i++)
+                if (i + (i & -i) <= n)
+                        lot->tree[i + (i & -i)] += lot->tree[i];
+        for (lot->top = 1; lot->top * 2 <= lot->n; lot->top *= 2)
+                ;
+}
+
+/**
+* lottery_find - 추첨한 번호 @r이 들어가는 칸을 찾음
+* @lot: 티켓 트리
+* @r: 0 이상 total 미만의 번호
+*/
+static inline int lottery_find(const struct lottery *lot, unsigned long long r)
+{
+        int pos = 0;
+
+        for (int step = lot->top; step; step >>= 1) {
+                if (pos + step <= lot->n && lot->tree[pos + step] <= r) {
+                        pos += step;
+                        r -= lot->tree[pos];
+                }
+        }
+
+        return pos;
+}
+
+static inline unsigned long long lottery_rand(struct lottery *lot)
+{
+        lot->rnd ^= lot->rnd >> 12;
+        lot->rnd ^= lot->rnd << 25;
+        lot->rnd ^= lot->rnd >> 27;
+        return lot->rnd * 0x2545f4914f6cdd1dULL;
+}
+
+static void lottery_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        struct lottery *lot = sim->priv;
+
+        if (wjob->idx >= lot->n)
+                lottery_grow(lot, wjob->idx);
+        lot->slot[wjob->idx] = wjob;
+        lottery_add(lot, wjob->idx, job_tickets(wjob->job));
+}
+
+static struct wait_job *lottery_pick_next(struct sim *sim)
+{
+        struct lottery *lot = sim->priv;
+        struct wait_job *wjob;
+        int idx;
+
+        if (!lot->total)
+                return NULL;
+
+        idx = lottery_find(lot, lottery_rand(lot) % lot->total);
+        wjob = lot->slot[idx];
+        lottery_add(lot, idx, 0 - (unsigned long long)job_tickets(wjob->job));
+        return wjob;
+}
+
+/*
+ * Lottery: 대기 중인 job들의 티켓 중 하나를 뽑아 그 job을 퀀텀만큼 수행
+ * 난수의 시드가 고정되어 있으므로 같은 입력은 같은 결과를 낸다
+ */
+const struct sched_class lottery_sched_class = {
+        .name           = "lottery",
+        .enqueue        = lottery_enqueue,
+        .pick_next      = lottery_pick_next,
+        .on_tick        = share_on_tick,
+        .on_preempt     = lottery_enqueue,
+        .on_timer       = NULL,
+        .on_done        = NULL,
+        .init           = lottery_init,
+        .exit           = lottery_exit,
+        .fork           = lottery_fork,
+        .flags          = 0
+};
+
+/**
+* get_lottery_time - Lottery 스케쥴링으로 수행된 job들의
+*                    총 turnaround time과 총 response time을 구함
+* @head: job 목록
+*/
+struct time_info get_lottery_time(const struct job_head *head)
+{
+        return sim_simulate(&lottery_sched_class, head);
+}
+
+/*
+ * 계층적 fair-share
+ *
+ * job은 그룹 (사용자)에 속하고 그룹마다 자기 대기 목록 큐를 가진다
+ * 위 단계에서는 대기 중인 job이 있는 그룹들을 그룹 가상 시간 순의
+ * 레드블랙트리로 관리해 가상 시간이 가장 작은 그룹을 고르고,
+ * 아래 단계에서는 그 그룹의 큐에서 Round Robin으로 job을 고른다
+ * 그룹은 수행한 만큼 가상 시간이 늘어나므로 그룹마다 같은 몫을 받는다
+ * 결정 하나의 비용은 O(log 그룹 수)
+ */
+struct fair_group {
+        struct rb_node                  node;
+        struct list_head                rq;
+        unsigned long long              vtime;
+        int                             queued;
+        struct time_info                info;
+};
+
+struct fair {
+        struct rb_root                  groups;
+        struct fair_group               *grp;
+        int                             nr_groups;
+};
+
+/**
+* job_group - job이 속한 그룹 번호를 구함
+* @job: job의 정보
+*/
+static inline int job_group(const struct job_info *job)
+{
+        return max(job->group, 0);
+}
+
+static void fair_init(struct sim *sim)
+{
+        struct fair *fair = malloc(sizeof(struct fair));
+        int nr_groups = 1;
+
+        for (int i = 0; sim->jobs && i < sim->job_cnt; i++)
+                nr_groups = max(nr_groups, job_group(sim->jobs + i) + 1);
+
+        fair->groups = RB_ROOT;
+        fair->nr_groups = nr_groups;
+        fair->grp = calloc(nr_groups, sizeof(struct fair_group));
+        for (int g = 0; g < nr_groups; g++)
+                INIT_LIST_HEAD(&fair->grp[g].rq);
+        sim->priv = fair;
+}
+
+/*
+ * 그룹 트리와 그룹 큐는 서로, 그리고 wait_job들과 이어져 있으므로
+ * 그룹 배열을 주소 표에 넣은 뒤에 포인터를 고친다
+ */
+static void fair_fork(struct sim *dst, const struct sim *src,
+                      struct reloc *r)
+{
+        const struct fair *from = src->priv;
+        struct fair *fair = malloc(sizeof(struct fair));
+
+        *fair = *from;
+        fair->grp = malloc(fair->nr_groups * sizeof(struct fair_group));
+        memcpy(fair->grp, from->grp,
+               fair->nr_groups * sizeof(struct fair_group));
+        reloc_add(r, from->grp, fair->nr_groups * sizeof(struct fair_group),
+                  fair->grp);
+
+        fair->groups.rb_node = reloc_ptr(r, fair->groups.rb_node);
+        for (int g = 0; g < fair->nr_groups; g++) {
+                if (fair->grp[g].queued)
+                        reloc_rb(r, &fair->grp[g].node);
+                reloc_list(r, &fair->grp[g].rq);
+        }
+        dst->priv = fair;
+}
+
+static void fair_exit(struct sim *sim)
+{
+        struct fair *fair = sim->priv;
+
+        free(fair->grp);
+        free(fair);
+        sim->priv = NULL;
+}
+
+/**
+* fair_queue_group - 그룹을 가상 시간 순으로 위 단계 트리에 넣음
+* @fair: fair-share 상태
+* @grp: 대기 중인 job이 생긴 그룹
+*
+* 가상 시간이 같으면 먼저 들어온 그룹이 왼쪽에 남는다
+*/
+static void fair_queue_group(struct fair *fair, struct fair_group *grp)
+{
+        struct rb_node **node = &(fair->groups.rb_node), *parent = NULL;
+
+        while (*node) {
+                struct fair_group *this = container_of(*node,
+                                                       struct fair_group,
+                                                       node);
+                parent = *node;
+                if (grp->vtime < this->vtime)
+                        node = &((*node)->rb_left);
+                else
+                        node = &((*node)->rb_right);
+        }
+
+        rb_link_node(&grp->node, parent, node);
+        rb_insert_color(&grp->node, &fair->groups);
+        grp->queued = 1;
+}
+
+/*
+ * 쉬고 있던 그룹은 전역 가상 시간보다 뒤처져 있으면 거기서 다시 시작
+ */
+static void fair_enqueue(struct sim *sim, struct wait_job *wjob)
+{
+        struct fair *fair = sim->priv;
+        struct fair_group *grp = fair->grp + job_group(wjob->job);
+
+        list_add_tail(&wjob->rr_list, &grp->rq);
+        if (!grp->queued) {
+                grp->vtime = max(grp->vtime, sim->vtime);
+                fair_queue_group(fair, grp);
+        }
+}
+
+/*
+ * 고른 그룹은 트리에서 빼 두었다가 수행 시간을 가상 시간에 더한 뒤
+ * (on_tick) 남은 job이 있으면 다시 넣는다
+ */
+static struct wait_job *fair_pick_next(struct sim *sim)
+{
+        struct fair *fair = sim->priv;
+        struct fair_group *grp;
+        struct wait_job *wjob;
+
+        if (RB_EMPTY_ROOT(&fair->groups))
+                return NULL;
+
+        grp = container_of(rb_first(&fair->groups), struct fair_group, node);
+        rb_erase(&grp->node, &fair->groups);
+        grp->queued = 0;
+        sim->vtime = grp->vtime;
+
+        wjob = get_rr_next(&grp->rq);
+        list_del(&wjob->rr_list);
+        return wjob;
+}
+
+static sched_time_t fair_on_tick(struct sim *sim, struct wait_job *wjob)
+{
+        struct fair *fair = sim->priv;
+        struct fair_group *grp = fair->grp + job_group(wjob->job);
+        sched_time_t slice = share_on_tick(sim, wjob);
+
+        if (first_sched(wjob))
+                grp->info.resp_time += sim->now - wjob->arrived;
+
+        grp->vtime += slice;
+        if (!list_empty(&grp->rq))
+                fair_queue_group(fair, grp);
+        return slice;
+}
+
+static void fair_on_done(struct sim *sim, struct wait_job *wjob)
+{
+        struct fair *fair = sim->priv;
+        struct fair_group *grp = fair->grp + job_group(wjob->job);
+
+        grp->info.tard_time += sim->now - wjob->arrived;
+}
+
+const struct sched_class fair_sched_class = {
+        .name           = "fair",
+        .enqueue        = fair_enqueue,
+        .pick_next      = fair_pick_next,
+        .on_tick        = fair_on_tick,
+        .on_preempt     = fair_enqueue,
+        .on_timer       = NULL,
+        .on_done        = fair_on_done,
+        .init           = fair_init,
+        .exit           = fair_exit,
+        .fork           = fair_fork,
+        .flags          = 0
+};
+
+/**
+* get_fair_time - 계층적 fair-share 스케쥴링으로 수행된 job들의
+*                 총 turnaround time과 총 response time을 구함
+* @head: job 목록
+* @groups: 그룹별 시간 정보를 기록할 배열 (필요 없으면 NULL)
+* @nr_groups: @groups의 크기, 이보다 번호가 큰 그룹은 기록하지 않음
+*/
+struct time_info get_fair_time(const struct job_head *head,
+                               struct time_info *groups, const int nr_groups)
+{
+        struct sim sim;
+        struct fair *fair;
+
+        sim_init(&sim, &fair_sched_class, head);
+        sim_run(&sim);
+
+        fair = sim.priv;
+        for (int g = 0; groups && g < nr_groups; g++) {
+                struct time_info empty = { 0 };
+
+                groups[g] = g < fair->nr_groups ? fair->grp[g].info : empty;
+        }
+
+        sim_destroy(&sim);
+        return sim.info;
+}
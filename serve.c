@@ -0,0 +1,254 @@
+﻿#include <stdlib.h>
+#include "serve.h"
+
+#ifdef _MSC_VER
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+/*
+ * 받은 job은 크기가 고정된 chunk에 모아 두고 chunk를 옮기지 않으므로
+ * 시뮬레이션이 가리키는 job_info는 데몬이 끝날 때까지 그대로 있다
+ * 프레임 하나로 받은 job들은 바로 넣지 않고 모아 두었다가
+ * ADVANCE나 chunk가 찼을 때 한꺼번에 sim_feed로 넣는다
+ */
+#define NR_SERVE_CHUNK  4096
+
+struct serve_chunk {
+        struct serve_chunk              *next;
+        int                             nr;
+        struct job_info                 jobs[NR_SERVE_CHUNK];
+};
+
+/*
+ * @last: 지금까지 받은 job의 마지막 arrival time
+ * @buf: ARRIVE 프레임의 job들을 확인하기 전에 읽어 두는 곳
+ */
+struct server {
+        struct sim                      sim[NR_SERVE_POLICY];
+        struct serve_chunk              *chunks;
+        struct serve_chunk              *tail;
+        int                             fed;
+        sched_time_t                    horizon;
+        sched_time_t                    last;
+        struct serve_job                *buf;
+        unsigned int                    buf_cap;
+};
+
+static const struct sched_class *const serve_class[NR_SERVE_POLICY] = {
+        &fcfs_sched_class,
+        &sjf_sched_class,
+        &rr_sched_class
+};
+
+/**
+* serve_flush - 모아 둔 job들을 시뮬레이션에 넣음
+* @srv: 데몬 상태
+*/
+static void serve_flush(struct server *srv)
+{
+        struct serve_chunk *tail = srv->tail;
+        int cnt = tail ? tail->nr - srv->fed : 0;
+
+        for (int p = 0; p < NR_SERVE_POLICY; p++)
+                sim_feed(srv->sim + p, cnt ? tail->jobs + srv->fed : NULL,
+                         cnt, srv->horizon);
+        if (tail)
+                srv->fed = tail->nr;
+}
+
+static void serve_add_job(struct server *srv, const struct serve_job *job)
+{
+        struct job_info *info;
+
+        if (!srv->tail || srv->tail->nr == NR_SERVE_CHUNK) {
+                struct serve_chunk *chunk = malloc(sizeof(struct serve_chunk));
+
+                if (srv->tail)
+                        serve_flush(srv);
+                chunk->next = NULL;
+                chunk->nr = 0;
+                if (srv->tail)
+                        srv->tail->next = chunk;
+                else
+                        srv->chunks = chunk;
+                srv->tail = chunk;
+                srv->fed = 0;
+        }
+
+        info = srv->tail->jobs + srv->tail->nr++;
+        info->arrived = job->arrived;
+        info->amount_time = job->amount_time;
+        info->deadline = 0;
+        info->prio = 0;
+        info->tickets = 0;
+        info->group = 0;
+}
+
+static int serve_reply(struct server *srv, FILE *out, const unsigned int op)
+{
+        struct serve_hdr hdr = {
+                .op = op,
+                .len = NR_SERVE_POLICY * sizeof(struct serve_stat)
+        };
+        struct serve_stat stat[NR_SERVE_POLICY];
+
+        for (int p = 0; p < NR_SERVE_POLICY; p++) {
+                struct sim *sim = srv->sim + p;
+
+                stat[p].now = sim->now;
+                stat[p].nr_arrived = sim->nr_arrived;
+                stat[p].nr_ready = sim->nr_ready;
+                stat[p].tard_time = sim->info.tard_time;
+                stat[p].resp_time = sim->info.resp_time;
+        }
+
+        if (fwrite(&hdr, sizeof(hdr), 1, out) != 1 ||
+            fwrite(stat, sizeof(stat), 1, out) != 1)
+                return -1;
+        return fflush(out) ? -1 : 0;
+}
+
+static int serve_error(FILE *out)
+{
+        struct serve_hdr hdr = {
+                .op = SERVE_ERROR,
+                .len = 0
+        };
+
+        if (fwrite(&hdr, sizeof(hdr), 1, out) != 1)
+                return -1;
+        return fflush(out) ? -1 : 0;
+}
+
+/**
+* serve_arrive - ARRIVE 프레임의 job들을 확인하고 받음
+* @srv: 데몬 상태
+* @nr: 프레임의 job 수
+* @in: 본문을 읽을 스트림
+* @out: 응답을 쓸 스트림
+*
+* 순서가 어긋났거나 horizon 이하에 도착하는 job이 있으면 하나도 받지
+* 않고 SERVE_ERROR로 응답한다. 본문을 다 읽지 못하면 -1을 돌려줌
+*/
+static int serve_arrive(struct server *srv, const unsigned int nr, FILE *in,
+                        FILE *out)
+{
+        sched_time_t last = srv->last;
+
+        if (nr > srv->buf_cap) {
+                free(srv->buf);
+                srv->buf_cap = max(nr, 2 * srv->buf_cap);
+                srv->buf = malloc(srv->buf_cap * sizeof(struct serve_job));
+        }
+        if (nr && fread(srv->buf, sizeof(struct serve_job), nr, in) != nr)
+                return -1;
+
+        for (unsigned int i = 0; i < nr; i++) {
+                if (srv->buf[i].arrived < last ||
+                    srv->buf[i].arrived <= srv->horizon)
+                        return serve_error(out);
+                last = srv->buf[i].arrived;
+        }
+
+        for (unsigned int i = 0; i < nr; i++)
+                serve_add_job(srv, srv->buf + i);
+        if (nr)
+                srv->last = last;
+        return 0;
+}
+
+/**
+* serve_frame - 프레임 하나를 처리
+* @srv: 데몬 상태
+* @hdr: 읽어 들인 프레임 헤더
+* @in: 본문을 읽을 스트림
+* @out: 응답을 쓸 스트림
+*
+* 데몬을 마쳐야 하면 1, 잘못된 프레임이면 -1을 돌려줌
+*/
+static int serve_frame(struct server *srv, const struct serve_hdr *hdr,
+                       FILE *in, FILE *out)
+{
+        sched_time_t horizon;
+
+        switch (hdr->op) {
+        case SERVE_ARRIVE:
+                if (hdr->len % sizeof(struct serve_job))
+                        return -1;
+                return serve_arrive(srv, hdr->len / sizeof(struct serve_job),
+                                    in, out);
+        case SERVE_ADVANCE:
+                if (hdr->len != sizeof(horizon) ||
+                    fread(&horizon, sizeof(horizon), 1, in) != 1)
+                        return -1;
+                srv->horizon = max(srv->horizon, horizon);
+                serve_flush(srv);
+                for (int p = 0; p < NR_SERVE_POLICY; p++)
+                        sim_run(srv->sim + p);
+                return 0;
+        case SERVE_QUERY:
+                if (hdr->len)
+                        return -1;
+                return serve_reply(srv, out, SERVE_QUERY);
+        case SERVE_CLOSE:
+                if (hdr->len)
+                        return -1;
+                serve_flush(srv);
+                for (int p = 0; p < NR_SERVE_POLICY; p++) {
+                        sim_close(srv->sim + p);
+                        sim_run(srv->sim + p);
+                }
+                return serve_reply(srv, out, SERVE_CLOSE) ? -1 : 1;
+        }
+
+        return -1;
+}
+
+/**
+* serve - 데몬 모드로 프레임을 처리
+* @in: 프레임을 읽을 스트림
+* @out: 응답을 쓸 스트림
+*
+* CLOSE나 EOF로 끝나면 0, 잘못된 프레임을 받으면 -1을 돌려줌
+*/
+int serve(FILE *in, FILE *out)
+{
+        struct server *srv = malloc(sizeof(struct server));
+        struct serve_hdr hdr;
+        int ret = 0;
+
+#ifdef _MSC_VER
+        _setmode(_fileno(in), _O_BINARY);
+        _setmode(_fileno(out), _O_BINARY);
+#endif
+
+        for (int p = 0; p < NR_SERVE_POLICY; p++)
+                sim_open(srv->sim + p, serve_class[p]);
+        srv->chunks = NULL;
+        srv->tail = NULL;
+        srv->fed = 0;
+        srv->horizon = SCHED_TIME_MIN;
+        srv->last = SCHED_TIME_MIN;
+        srv->buf = NULL;
+        srv->buf_cap = 0;
+
+        while (fread(&hdr, sizeof(hdr), 1, in) == 1) {
+                ret = serve_frame(srv, &hdr, in, out);
+                if (ret)
+                        break;
+        }
+
+        for (int p = 0; p < NR_SERVE_POLICY; p++)
+                sim_destroy(srv->sim + p);
+        while (srv->chunks) {
+                struct serve_chunk *next = srv->chunks->next;
+
+                free(srv->chunks);
+                srv->chunks = next;
+        }
+        free(srv->buf);
+        free(srv);
+
+        return ret < 0 ? -1 : 0;
+}
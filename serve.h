@@ -0,0 +1,60 @@
+﻿#ifndef _SERVE_H
+#define _SERVE_H
+
+#include <stdio.h>
+#include "sim.h"
+
+/*
+ * 데몬 모드 (main -s)
+ *
+ * 파이프로 job의 도착을 받아 FCFS, SJF, RR 시뮬레이션을 이어서 진행하고
+ * 지금까지의 결과를 묻는 질의에 답한다
+ * 모든 프레임은 struct serve_hdr로 시작하고 @len 바이트의 본문이 뒤따른다
+ * 정수는 모두 호스트 바이트 순서의 32비트
+ *
+ * SERVE_ARRIVE: 본문은 arrival time 순으로 정렬된 struct serve_job 배열
+ *               앞서 받은 job보다 먼저 도착하거나 ADVANCE로 지나간 시간
+ *               이하에 도착하는 job이 있으면 프레임의 job을 모두 버리고
+ *               SERVE_ERROR 헤더 (본문 없음)로 응답
+ * SERVE_ADVANCE: 본문은 sched_time_t 하나로, 그 시간까지 도착하는
+ *                job은 모두 보냈다는 뜻이며 시뮬레이션을 거기까지 진행
+ * SERVE_QUERY: 본문 없음
+ * SERVE_CLOSE: 본문 없음, 남은 job을 모두 끝내고 데몬을 마침
+ *
+ * QUERY와 CLOSE에는 같은 op의 헤더 뒤에 정책마다 struct serve_stat
+ * 하나씩 (FCFS, SJF, RR 순서) 붙여 응답한다
+ */
+enum serve_op {
+        SERVE_ARRIVE = 1,
+        SERVE_ADVANCE,
+        SERVE_QUERY,
+        SERVE_CLOSE,
+        SERVE_ERROR
+};
+
+struct serve_hdr {
+        unsigned int                    op;
+        unsigned int                    len;
+};
+
+struct serve_job {
+        sched_time_t                    arrived;
+        sched_time_t                    amount_time;
+};
+
+/*
+ * @nr_ready는 도착했지만 아직 끝나지 않은 job 수
+ */
+struct serve_stat {
+        sched_time_t                    now;
+        int                             nr_arrived;
+        int                             nr_ready;
+        int                             tard_time;
+        int                             resp_time;
+};
+
+#define NR_SERVE_POLICY         3
+
+extern int serve(FILE *in, FILE *out);
+
+#endif
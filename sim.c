@@ -0,0 +1,875 @@
+﻿#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "timeline.h"
+
+#define NR_WJOB_SLAB    256
+
+#ifdef _MSC_VER
+#define __sim_thread    __declspec(thread)
+#else
+#define __sim_thread    _Thread_local
+#endif
+
+/*
+ * struct sim_ctx - 스레드마다 하나씩 두고 시뮬레이션 사이에 재사용하는 메모리
+ *
+ * 끝난 시뮬레이션의 wait_job slab과 이벤트 node slab을 여기 모아 두었다가
+ * 다음 시뮬레이션이 malloc 대신 꺼내 쓴다
+ * 따라서 가장 많이 썼을 때만큼 자란 뒤로는 할당이 일어나지 않는다
+ */
+struct sim_ctx {
+        struct wjob_slab                *wjob_spare;
+        struct evq_slab                 *evq_spare;
+};
+
+static __sim_thread struct sim_ctx sim_ctx;
+
+/* 나머지 열 없이 SoA 열만 있는 목록의 job들이 가리키는 job_info */
+static const struct job_info job_info_none;
+
+/**
+* sim_arrived_at - 지금 job 목록에서 @pos번째 job의 arrival time을 구함
+* @sim: 시뮬레이션
+* @pos: 지금 job 목록에서 job의 위치
+*/
+static inline sched_time_t sim_arrived_at(const struct sim *sim,
+                                          const int pos)
+{
+        return sim->arrived ? sim->arrived[pos] : (sim->jobs + pos)->arrived;
+}
+
+/**
+* sim_alloc_wjob - 풀에서 wait_job을 하나 꺼내 초기화
+* @sim: 시뮬레이션
+* @pos: 지금 job 목록에서 job의 위치
+* @idx: job의 job 목록에서의 인덱스 (여러 목록을 넣었으면 전체에서의 순서)
+*
+* 풀이 비었으면 스레드에 남아 있는 slab을 쓰고, 그것도 없을 때만
+* slab 하나를 새로 할당한다
+*/
+struct wait_job *sim_alloc_wjob(struct sim *sim, const int pos,
+                                const int idx)
+{
+        struct wjob_pool *pool = &sim->pool;
+        struct wait_job *wjob;
+
+        if (list_empty(&pool->free_list)) {
+                struct wjob_slab *slab = sim_ctx.wjob_spare;
+
+                if (slab) {
+                        sim_ctx.wjob_spare = slab->next;
+                } else {
+                        slab = malloc(sizeof(struct wjob_slab) +
+                                (NR_WJOB_SLAB - 1) * sizeof(struct wait_job));
+                        slab->nr = NR_WJOB_SLAB;
+                }
+
+                slab->next = pool->slabs;
+                pool->slabs = slab;
+                for (int i = 0; i < slab->nr; i++)
+                        list_add_tail(&slab->objs[i].rr_list,
+                                      &pool->free_list);
+        }
+
+        wjob = container_of(pool->free_list.next, struct wait_job, rr_list);
+        list_del(&wjob->rr_list);
+        pool->used++;
+
+        wjob->job = sim->jobs ? sim->jobs + pos : &job_info_none;
+        wjob->arrived = sim_arrived_at(sim, pos);
+        wjob->idx = idx;
+        wjob->run_time = 0;
+        wjob->ready = wjob->arrived;
+        wjob->burst_nr = 0;
+        wjob->pass = 0;
+        if (sim->bursts) {
+                assert(nr_bursts_of(sim->bursts, idx) % 2 == 1);
+                wjob->burst = burst_of(sim->bursts, idx, 0);
+        } else if (sim->amount_time)
+                wjob->burst = sim->amount_time[pos];
+        else
+                wjob->burst = (sim->jobs + pos)->amount_time;
+        return wjob;
+}
+
+/**
+* sim_free_wjob - 끝난 wait_job을 풀에 돌려놓음
+* @sim: 시뮬레이션
+* @wjob: 대기 목록에서 빠진 wait_job
+*/
+void sim_free_wjob(struct sim *sim, struct wait_job *wjob)
+{
+        list_add(&wjob->rr_list, &sim->pool.free_list);
+        sim->pool.used--;
+}
+
+/**
+* sim_init - 시뮬레이션을 준비
+* @sim: 시뮬레이션
+* @class: 스케쥴링 정책
+* @head: arrival time 순으로 정렬된 job 목록
+*/
+void sim_init(struct sim *sim, const struct sched_class *class,
+              const struct job_head *head)
+{
+        sim->class = class;
+        sim->jobs = head->jobs;
+        sim->arrived = head->arrived;
+        sim->amount_time = head->amount_time;
+        sim->job_cnt = head->job_cnt;
+        sim->bursts = head->bursts;
+        sim->deadline = head->deadline;
+        sim->trav = 0;
+        sim->nr_arrived = 0;
+        sim->feed = NULL;
+        sim->feed_head = 0;
+        sim->nr_feed = 0;
+        sim->feed_cap = 0;
+        sim->horizon = SCHED_TIME_MAX;
+        sim->closed = 1;
+
+        sim->now = head->job_cnt ? job_head_arrived(head, 0) : 0;
+        sim->quantum = NR_RR_QUANTUM;
+        sim->info.tard_time = 0;
+        sim->info.resp_time = 0;
+        sim->info.miss_cnt = 0;
+        sim->info.late_time = 0;
+        sim->nr_ready = 0;
+        sim->nr_io = 0;
+        sim->curr = NULL;
+        sim->curr_slice = 0;
+
+        sim->rq_tree = RB_ROOT;
+        INIT_LIST_HEAD(&sim->rq_list);
+        sim->rq_prio.bitmap = 0;
+        sim->rq_prio.epoch = prio_epoch(sim->now);
+        sim->vtime = 0;
+        evq_init(&sim->evq);
+        evq_adopt(&sim->evq, &sim_ctx.evq_spare);
+        sim->pool.slabs = NULL;
+        INIT_LIST_HEAD(&sim->pool.free_list);
+        sim->pool.used = 0;
+        sim->priv = NULL;
+        sim->timeline = NULL;
+        sim->forked = 0;
+
+        if (class->init)
+                class->init(sim);
+}
+
+/**
+* sim_destroy - 시뮬레이션이 쓴 메모리를 정리
+* @sim: 시뮬레이션
+*
+* slab들은 해제하지 않고 스레드의 sim_ctx에 돌려준다
+* sim_fork로 만든 시뮬레이션의 slab은 sim_ctx에서 꺼낸 것이 아니므로
+* 돌려주면 fork할 때마다 sim_ctx가 자라기만 한다. 이때는 해제한다
+*/
+void sim_destroy(struct sim *sim)
+{
+        struct wjob_slab *slab = sim->pool.slabs;
+
+        if (sim->class->exit)
+                sim->class->exit(sim);
+
+        while (slab) {
+                struct wjob_slab *next = slab->next;
+
+                if (sim->forked) {
+                        free(slab);
+                } else {
+                        slab->next = sim_ctx.wjob_spare;
+                        sim_ctx.wjob_spare = slab;
+                }
+                slab = next;
+        }
+        sim->pool.slabs = NULL;
+        INIT_LIST_HEAD(&sim->pool.free_list);
+        if (sim->forked)
+                evq_free(&sim->evq);
+        else
+                evq_release(&sim->evq, &sim_ctx.evq_spare);
+        free(sim->feed);
+        sim->feed = NULL;
+}
+
+/**
+* sim_ctx_free - 이 스레드에 남아 있는 slab들을 모두 해제
+*
+* 스레드가 더 이상 시뮬레이션을 하지 않을 때 부른다
+*/
+void sim_ctx_free(void)
+{
+        struct evq evq;
+
+        while (sim_ctx.wjob_spare) {
+                struct wjob_slab *next = sim_ctx.wjob_spare->next;
+
+                free(sim_ctx.wjob_spare);
+                sim_ctx.wjob_spare = next;
+        }
+
+        evq_init(&evq);
+        evq_adopt(&evq, &sim_ctx.evq_spare);
+        evq_free(&evq);
+}
+
+/**
+* sim_fork - 멈춘 시뮬레이션을 복사해 따로 이어 갈 수 있게 함
+* @dst: 새 시뮬레이션
+* @src: 복사할 시뮬레이션
+*
+* wait_job slab들은 slab 하나로 모아 복사하고 이벤트 큐와 정책 상태도
+* 통째로 복사한 뒤 그 안의 포인터만 주소 표로 고친다
+* job 목록은 복사하지 않고 함께 쓰며, 복사한 뒤에는 둘에게 서로 다른
+* job을 넣어도 된다
+* timeline은 따라가지 않으므로 필요하면 새로 붙인다
+* 정책 전용 상태가 있는데 fork 연산이 없으면 -1을 돌려줌
+*/
+int sim_fork(struct sim *dst, const struct sim *src)
+{
+        const struct wjob_slab *from;
+        struct wjob_slab *slab = NULL;
+        struct reloc r;
+        int nr = 0;
+
+        if (src->priv && !src->class->fork)
+                return -1;
+
+        *dst = *src;
+        dst->timeline = NULL;
+        dst->forked = 1;
+        reloc_init(&r);
+        reloc_add(&r, src, sizeof(struct sim), dst);
+
+        for (from = src->pool.slabs; from; from = from->next)
+                nr += from->nr;
+        if (nr) {
+                slab = malloc(sizeof(struct wjob_slab) +
+                              (nr - 1) * sizeof(struct wait_job));
+                slab->next = NULL;
+                slab->nr = 0;
+                for (from = src->pool.slabs; from; from = from->next) {
+                        memcpy(slab->objs + slab->nr, from->objs,
+                               from->nr * sizeof(struct wait_job));
+                        reloc_add(&r, from->objs,
+                                  from->nr * sizeof(struct wait_job),
+                                  slab->objs + slab->nr);
+                        slab->nr += from->nr;
+                }
+        }
+        dst->pool.slabs = slab;
+
+        evq_clone(&dst->evq, &src->evq, &r);
+        if (src->feed) {
+                dst->feed = malloc(src->feed_cap * sizeof(struct job_head));
+                memcpy(dst->feed, src->feed,
+                       src->feed_cap * sizeof(struct job_head));
+        }
+        if (src->priv)
+                src->class->fork(dst, src, &r);
+
+        dst->rq_tree.rb_node = reloc_ptr(&r, dst->rq_tree.rb_node);
+        reloc_list(&r, &dst->rq_list);
+        for (int i = 0; i < NR_PRIO; i++)
+                if (dst->rq_prio.bitmap & (1ULL << i))
+                        reloc_list(&r, dst->rq_prio.queue + i);
+        dst->curr = reloc_ptr(&r, dst->curr);
+
+        reloc_list(&r, &dst->pool.free_list);
+        for (int i = 0; i < nr; i++) {
+                reloc_rb(&r, &slab->objs[i].sjf_node);
+                reloc_list(&r, &slab->objs[i].rr_list);
+        }
+        evq_reloc(&dst->evq, &r);
+
+        reloc_free(&r);
+        return 0;
+}
+
+/**
+* sim_open - job을 나중에 조금씩 넣을 시뮬레이션을 준비
+* @sim: 시뮬레이션
+* @class: 스케쥴링 정책
+*
+* job은 sim_feed로 넣고 다 넣었으면 sim_close를 부른다
+* 시간은 처음 넣은 job의 arrival time에서 시작한다
+* fair처럼 init에서 job 목록 전체를 보는 정책은 쓸 수 없고
+* multi-burst job도 받지 않는다
+*/
+void sim_open(struct sim *sim, const struct sched_class *class)
+{
+        struct job_head head = {
+                .jobs = NULL,
+                .job_cnt = 0,
+                .bursts = NULL,
+                .deadline = 1
+        };
+
+        sim_init(sim, class, &head);
+        sim->horizon = SCHED_TIME_MIN;
+        sim->closed = 0;
+}
+
+/**
+* sim_next_batch - 다 쓴 job 목록 대신 기다리던 다음 목록을 꺼냄
+* @sim: 시뮬레이션
+*/
+static inline void sim_next_batch(struct sim *sim)
+{
+        struct job_head *batch;
+
+        if (!sim->nr_feed)
+                return;
+
+        batch = sim->feed + sim->feed_head;
+        sim->jobs = batch->jobs;
+        sim->arrived = batch->arrived;
+        sim->amount_time = batch->amount_time;
+        sim->job_cnt = batch->job_cnt;
+        sim->trav = 0;
+        sim->feed_head = (sim->feed_head + 1) % sim->feed_cap;
+        sim->nr_feed--;
+}
+
+/**
+* sim_feed_head - 도착할 job 목록 하나를 원형 큐에 넣음
+* @sim: sim_open으로 연 시뮬레이션
+* @batch: job 목록
+* @horizon: 이 시간까지 도착하는 job은 모두 넣었음
+*/
+static void sim_feed_head(struct sim *sim, const struct job_head *batch,
+                          const sched_time_t horizon)
+{
+        sim->horizon = max(sim->horizon, horizon);
+        if (!batch->job_cnt)
+                return;
+        /* arrival time이 음수일 수 있으므로 0이 아닌 첫 job에서 시작 */
+        if (!sim->nr_arrived && !sim_feed_pending(sim)) {
+                sim->now = job_head_arrived(batch, 0);
+                sim->rq_prio.epoch = prio_epoch(sim->now);
+        }
+
+        if (sim->nr_feed == sim->feed_cap) {
+                int cap = sim->feed_cap ? sim->feed_cap * 2 : 4;
+                struct job_head *feed = malloc(cap * sizeof(struct job_head));
+
+                for (int i = 0; i < sim->nr_feed; i++)
+                        feed[i] = sim->feed[(sim->feed_head + i) %
+                                            sim->feed_cap];
+                free(sim->feed);
+                sim->feed = feed;
+                sim->feed_head = 0;
+                sim->feed_cap = cap;
+        }
+
+        sim->feed[(sim->feed_head + sim->nr_feed) % sim->feed_cap] = *batch;
+        sim->nr_feed++;
+
+        if (!sim_arrival_pending(sim))
+                sim_next_batch(sim);
+}
+
+/**
+* sim_feed - 도착할 job들을 시뮬레이션에 넣음
+* @sim: sim_open으로 연 시뮬레이션
+* @jobs: arrival time 순으로 정렬된 job 목록, 모두 끝날 때까지 유지되어야 함
+* @cnt: @jobs의 job 수 (0이면 @horizon만 옮김)
+* @horizon: 이 시간까지 도착하는 job은 모두 넣었음
+*
+* 앞서 넣은 job보다 먼저 도착하는 job은 넣을 수 없다
+* 아직 도착하지 않은 목록들은 원형 큐에서 차례를 기다린다
+*/
+void sim_feed(struct sim *sim, const struct job_info *jobs, const int cnt,
+              const sched_time_t horizon)
+{
+        struct job_head batch = {
+                .jobs = (struct job_info *)jobs,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 1,
+                .arrived = NULL,
+                .amount_time = NULL
+        };
+
+        sim_feed_head(sim, &batch, horizon);
+}
+
+/**
+* sim_feed_cols - 도착할 job들을 SoA 열로 시뮬레이션에 넣음
+* @sim: sim_open으로 연 시뮬레이션
+* @arrived: arrival time 순으로 정렬된 arrival time 열
+* @amount_time: amount time 열
+* @cnt: job 수 (0이면 @horizon만 옮김)
+* @horizon: 이 시간까지 도착하는 job은 모두 넣었음
+*
+* sim_feed와 달리 job이 도착하면 열을 더 읽지 않으므로, 열은
+* 시뮬레이션이 그 목록을 지나갈 때까지만 (sim_feed_pending 참고) 두면 된다
+*/
+void sim_feed_cols(struct sim *sim, const sched_time_t *arrived,
+                   const sched_time_t *amount_time, const int cnt,
+                   const sched_time_t horizon)
+{
+        struct job_head batch = {
+                .jobs = NULL,
+                .job_cnt = cnt,
+                .bursts = NULL,
+                .deadline = 1,
+                .arrived = (sched_time_t *)arrived,
+                .amount_time = (sched_time_t *)amount_time
+        };
+
+        sim_feed_head(sim, &batch, horizon);
+}
+
+/**
+* sim_next_event - 현재 시간 이후 가장 빠른 이벤트의 시간을 구함
+* @sim: 시뮬레이션
+* @when: 이벤트의 시간을 기록
+*
+* 남은 이벤트가 없으면 0을 돌려줌
+*/
+static inline int sim_next_event(struct sim *sim, sched_time_t *when)
+{
+        int has = 0;
+
+        if (sim_arrival_pending(sim)) {
+                *when = sim_arrived_at(sim, sim->trav);
+                has = 1;
+        }
+        if (!evq_empty(&sim->evq) && (!has || evq_next(&sim->evq) < *when)) {
+                *when = evq_next(&sim->evq);
+                has = 1;
+        }
+
+        return has;
+}
+
+/**
+* sim_start_io - CPU burst가 끝난 job을 다음 I/O burst로 보냄
+* @sim: 시뮬레이션
+* @wjob: 현재 CPU burst가 끝난 job
+*
+* 남은 burst가 없으면 0을 돌려줌
+* I/O가 끝나는 시간에 이벤트를 걸어 두므로 I/O 중인 job은
+* 어느 대기 목록에도 없고 매 시간마다 확인할 필요도 없다
+*/
+static inline int sim_start_io(struct sim *sim, struct wait_job *wjob)
+{
+        int nr = 2 * wjob->burst_nr + 1;
+
+        if (!sim->bursts || nr >= nr_bursts_of(sim->bursts, wjob->idx))
+                return 0;
+
+        evq_push(&sim->evq, sim->now + burst_of(sim->bursts, wjob->idx, nr),
+                 SIM_EV_IO, wjob);
+        sim->nr_ready--;
+        sim->nr_io++;
+        return 1;
+}
+
+/**
+* sim_io_done - I/O burst가 끝난 job을 다음 CPU burst로 대기 목록에 넣음
+* @sim: 시뮬레이션
+* @wjob: I/O가 끝난 job
+* @when: I/O가 끝난 시간
+*/
+static inline void sim_io_done(struct sim *sim, struct wait_job *wjob,
+                               const sched_time_t when)
+{
+        wjob->burst_nr++;
+        assert(2 * wjob->burst_nr < nr_bursts_of(sim->bursts, wjob->idx));
+        wjob->burst = burst_of(sim->bursts, wjob->idx, 2 * wjob->burst_nr);
+        wjob->run_time = 0;
+        wjob->ready = when;
+        sim->nr_io--;
+        sim->nr_ready++;
+        sim->class->enqueue(sim, wjob);
+}
+
+/**
+* sim_arrival_window - 지금 job 목록에서 @bound까지 도착한 job 수를 구함
+* @sim: 시뮬레이션
+* @bound: 도착 시간의 상한
+*
+* trav의 job은 @bound까지 도착한 것이어야 한다
+* 한 시간에 job이 몰려 도착하는 목록에서 하나씩 비교하지 않도록
+* 1, 2, 4, ...칸씩 건너뛰며 (galloping) 경계를 감싼 뒤 이분 탐색으로
+* 좁히므로 n개가 도착했으면 비교는 O(log n)번이다
+* 하나만 도착했으면 다음 job 하나만 보고 끝난다
+*/
+static inline int sim_arrival_window(const struct sim *sim,
+                                     const sched_time_t bound)
+{
+        int lo = sim->trav, hi = sim->trav + 1, step = 1;
+
+        /* arrived(lo) <= bound이고 hi는 job_cnt이거나 arrived(hi) > bound */
+        while (hi < sim->job_cnt && sim_arrived_at(sim, hi) <= bound) {
+                lo = hi;
+                step *= 2;
+                hi = min(lo + step, sim->job_cnt);
+        }
+        while (hi - lo > 1) {
+                int mid = lo + (hi - lo) / 2;
+
+                if (sim_arrived_at(sim, mid) <= bound)
+                        lo = mid;
+                else
+                        hi = mid;
+        }
+
+        return hi - sim->trav;
+}
+
+/**
+* sim_arrive - 지금 job 목록에서 도착한 job @cnt개를 한꺼번에 대기 목록에 넣음
+* @sim: 시뮬레이션
+* @cnt: trav부터 도착한 job 수
+*/
+static inline void sim_arrive(struct sim *sim, const int cnt)
+{
+        const struct sched_class *class = sim->class;
+        const int end = sim->trav + cnt;
+
+        sim->nr_ready += cnt;
+        for (int pos = sim->trav; pos < end; pos++)
+                class->enqueue(sim, sim_alloc_wjob(sim, pos,
+                                                   sim->nr_arrived++));
+
+        sim->trav = end;
+        if (sim->trav == sim->job_cnt)
+                sim_next_batch(sim);
+}
+
+/**
+* sim_pull_events - 현재 시간까지 일어난 이벤트를 모두 처리
+* @sim: 시뮬레이션
+*
+* 도착한 job과 I/O가 끝난 job은 정책의 대기 목록에 넣고
+* 정책의 timer는 정책에 넘긴다
+* 같은 시간이면 arrival이 먼저, 그 다음은 등록 순서대로 처리된다
+* 다음 timer 전에 도착한 job들은 sim_arrival_window로 한 번에 찾는다
+* (정책은 enqueue에서 현재 시간 이후의 timer만 걸 수 있으므로
+* 그 사이에 끼어들 이벤트는 없다)
+*/
+static inline void sim_pull_events(struct sim *sim)
+{
+        const struct sched_class *class = sim->class;
+
+        for (;;) {
+                int arrival = sim_arrival_pending(sim) &&
+                        sim_arrived_at(sim, sim->trav) <= sim->now;
+                int timer = !evq_empty(&sim->evq) &&
+                        evq_next(&sim->evq) <= sim->now;
+
+                if (arrival && (!timer || sim_arrived_at(sim, sim->trav) <=
+                                          evq_next(&sim->evq))) {
+                        sched_time_t bound = timer ? evq_next(&sim->evq) :
+                                                     sim->now;
+
+                        sim_arrive(sim, sim_arrival_window(sim, bound));
+                } else if (timer) {
+                        struct sim_event ev = evq_pop(&sim->evq);
+
+                        if (ev.type == SIM_EV_IO)
+                                sim_io_done(sim, ev.data, ev.when);
+                        else
+                                class->on_timer(sim, &ev);
+                } else {
+                        break;
+                }
+        }
+}
+
+/**
+* sim_check_deadline - 끝난 job이 deadline을 넘겼는지 확인
+* @sim: 시뮬레이션
+* @wjob: 방금 끝난 job
+*/
+static inline void sim_check_deadline(struct sim *sim,
+                                      const struct wait_job *wjob)
+{
+        sched_time_t late;
+
+        if (!wjob->job->deadline)
+                return;
+
+        late = sim->now - job_deadline(wjob);
+        if (late > 0) {
+                sim->info.miss_cnt++;
+                sim->info.late_time += late;
+        }
+}
+
+/**
+* sim_start - job 하나의 수행을 시작
+* @sim: 시뮬레이션
+* @wjob: 대기 목록에서 꺼낸 job
+*
+* 처음 수행되면 response time을 계산하고 정책이 정한 수행 시간을
+* 기억해 둔다
+*/
+static inline void sim_start(struct sim *sim, struct wait_job *wjob)
+{
+        sim->curr = wjob;
+        sim->curr_slice = sim->class->on_tick(sim, wjob);
+
+        if (first_sched(wjob))
+                sim->info.resp_time += sim->now - wjob->arrived;
+}
+
+/**
+* sim_finish - 수행 중인 job을 끝나는 시간까지 진행
+* @sim: 시뮬레이션
+* @limit: 나아갈 수 있는 가장 늦은 시간
+*
+* 끝나는 시간이 @limit을 넘으면 아무것도 하지 않고 0을 돌려줌
+* 끝나면 turnaround time을 계산
+* 수행 중에 도착한 job들은 끝나지 않은 job이 되돌아가기 전에 들어간다
+* CPU burst가 끝났지만 I/O burst가 남았으면 I/O로 보낸다
+*/
+static inline int sim_finish(struct sim *sim, const sched_time_t limit)
+{
+        const struct sched_class *class = sim->class;
+        struct wait_job *wjob = sim->curr;
+        sched_time_t slice = sim->curr_slice;
+        sched_time_t next;
+
+        /* now가 음수일 수 있으므로 시간 차는 64비트로 비교 */
+        if ((class->flags & SCHED_PREEMPT_ARRIVAL) &&
+            sim_next_event(sim, &next) &&
+            (long long)next - sim->now < slice)
+                slice = next - sim->now;
+        if ((long long)sim->now + slice > limit)
+                return 0;
+
+        sim->curr = NULL;
+        sim->now += slice;
+        wjob->run_time += slice;
+        if (sim->timeline)
+                timeline_add(sim->timeline, wjob->idx, sim->now - slice,
+                             slice);
+        sim_pull_events(sim);
+
+        if (job_done(wjob)) {
+                if (sim_start_io(sim, wjob))
+                        return 1;
+                sim->info.tard_time += sim->now - wjob->arrived;
+                if (sim->deadline)
+                        sim_check_deadline(sim, wjob);
+                sim->nr_ready--;
+                if (class->on_done)
+                        class->on_done(sim, wjob);
+                sim_free_wjob(sim, wjob);
+        } else {
+                class->on_preempt(sim, wjob);
+        }
+
+        return 1;
+}
+
+/**
+* sim_advance - 스케쥴링 결정 하나만큼 시뮬레이션을 진행
+* @sim: 시뮬레이션
+* @limit: 나아갈 수 있는 가장 늦은 시간
+*
+* job 하나를 골라 정책이 정한 만큼 수행하거나, 대기 목록이 비었으면
+* 다음 이벤트 시간으로 바로 건너뛴다
+* 현재 시간에 도착할 job이 더 있을 수 있으면 고르지 않고 기다린다
+* @limit 안에서 더 나아갈 수 없으면 0을 돌려줌
+*/
+static inline int sim_advance(struct sim *sim, const sched_time_t limit)
+{
+        struct wait_job *wjob;
+        sched_time_t next;
+
+        if (sim->curr)
+                return sim_finish(sim, limit);
+        if (sim->now > limit)
+                return 0;
+
+        sim_pull_events(sim);
+        wjob = sim->class->pick_next(sim);
+        if (wjob) {
+                sim_start(sim, wjob);
+                return sim_finish(sim, limit);
+        }
+
+        if (!sim_next_event(sim, &next) || next > limit)
+                return 0;
+        sim->now = next;
+        return 1;
+}
+
+/*
+ * 아직 넣지 않은 job이 있을 수 있으면 horizon을 넘어 나아가지 않는다
+ */
+static inline sched_time_t sim_limit(const struct sim *sim,
+                                     const sched_time_t until)
+{
+        return sim->closed ? until : min(until, sim->horizon);
+}
+
+/**
+* sim_step - 스케쥴링 결정을 @nr개까지 진행
+* @sim: 시뮬레이션
+* @nr: 진행할 결정 수
+*
+* 실제로 진행한 결정 수를 돌려줌
+* @nr보다 작으면 모두 끝났거나 다음 job이 들어오기를 기다리는 중이다
+*/
+int sim_step(struct sim *sim, const int nr)
+{
+        const sched_time_t limit = sim_limit(sim, SCHED_TIME_MAX);
+        int done = 0;
+
+        while (done < nr && sim_advance(sim, limit))
+                done++;
+
+        return done;
+}
+
+/**
+* sim_run_until - @until 시간까지의 이벤트를 모두 처리
+* @sim: 시뮬레이션
+* @until: 멈출 시간
+*
+* 끝나는 시간이 @until을 넘는 수행은 시작만 해 두고 멈추므로
+* 멈춘 뒤의 시간은 @until 이하다
+*/
+void sim_run_until(struct sim *sim, const sched_time_t until)
+{
+        const sched_time_t limit = sim_limit(sim, until);
+
+        while (sim_advance(sim, limit))
+                ;
+}
+
+/*
+ * 특수화한 루프 (sim_kernel.h)가 쓰는 대기 목록 연산
+ * FCFS와 RR은 FIFO 큐, SJF는 레드블랙트리
+ */
+static inline void sim_kernel_list_push(struct sim *sim, struct wait_job *wjob)
+{
+        list_add_tail(&wjob->rr_list, &sim->rq_list);
+}
+
+static inline struct wait_job *sim_kernel_list_pop(struct sim *sim)
+{
+        struct wait_job *wjob;
+
+        if (list_empty(&sim->rq_list))
+                return NULL;
+
+        wjob = get_rr_next(&sim->rq_list);
+        list_del(&wjob->rr_list);
+        return wjob;
+}
+
+static inline void sim_kernel_tree_push(struct sim *sim, struct wait_job *wjob)
+{
+        sjf_push_wait_job(&sim->rq_tree, wjob);
+}
+
+static inline struct wait_job *sim_kernel_tree_pop(struct sim *sim)
+{
+        struct wait_job *wjob;
+
+        if (RB_EMPTY_ROOT(&sim->rq_tree))
+                return NULL;
+
+        wjob = get_shortest_job(&sim->rq_tree);
+        rb_erase(&wjob->sjf_node, &sim->rq_tree);
+        return wjob;
+}
+
+#define SIM_KERNEL_FN           sim_kernel_fcfs
+#define SIM_KERNEL_PULL         sim_kernel_fcfs_pull
+#define SIM_KERNEL_PUSH         sim_kernel_list_push
+#define SIM_KERNEL_POP          sim_kernel_list_pop
+#define SIM_KERNEL_QUANTUM(sim) 0
+#include "sim_kernel.h"
+
+#define SIM_KERNEL_FN           sim_kernel_sjf
+#define SIM_KERNEL_PULL         sim_kernel_sjf_pull
+#define SIM_KERNEL_PUSH         sim_kernel_tree_push
+#define SIM_KERNEL_POP          sim_kernel_tree_pop
+#define SIM_KERNEL_QUANTUM(sim) 0
+#include "sim_kernel.h"
+
+#define SIM_KERNEL_FN           sim_kernel_rr
+#define SIM_KERNEL_PULL         sim_kernel_rr_pull
+#define SIM_KERNEL_PUSH         sim_kernel_list_push
+#define SIM_KERNEL_POP          sim_kernel_list_pop
+#define SIM_KERNEL_QUANTUM(sim) NR_RR_QUANTUM
+#include "sim_kernel.h"
+
+#define SIM_KERNEL_FN           sim_kernel_rr_any
+#define SIM_KERNEL_PULL         sim_kernel_rr_any_pull
+#define SIM_KERNEL_PUSH         sim_kernel_list_push
+#define SIM_KERNEL_POP          sim_kernel_list_pop
+#define SIM_KERNEL_QUANTUM(sim) ((sim)->quantum)
+#include "sim_kernel.h"
+
+/**
+* sim_kernel_run - 특수화한 루프가 있으면 그것으로 시뮬레이션을 끝까지 진행
+* @sim: 시뮬레이션
+*
+* 정책이 FCFS, SJF, RR이고 I/O burst와 timeline이 없으며 더 넣을 job
+* 목록도 없을 때만 맞는 루프를 고르고, RR은 퀀텀이 NR_RR_QUANTUM이면
+* 상수 퀀텀 루프를 쓴다. 고를 루프가 없으면 0을 돌려줌
+* 대기 목록은 정책과 같은 것을 쓰므로 멈췄던 시뮬레이션도 이어 간다
+*/
+static int sim_kernel_run(struct sim *sim)
+{
+        const struct sched_class *class = sim->class;
+
+        if (sim->bursts || sim->nr_feed || !sim->closed || sim->timeline ||
+            sim->curr || !evq_empty(&sim->evq))
+                return 0;
+
+        if (class == &fcfs_sched_class)
+                sim_kernel_fcfs(sim);
+        else if (class == &sjf_sched_class)
+                sim_kernel_sjf(sim);
+        else if (class == &rr_sched_class && sim->quantum == NR_RR_QUANTUM)
+                sim_kernel_rr(sim);
+        else if (class == &rr_sched_class && sim->quantum > 0)
+                sim_kernel_rr_any(sim);
+        else
+                return 0;
+        return 1;
+}
+
+/**
+* sim_run - 모든 job이 끝날 때까지 시뮬레이션을 진행
+* @sim: 시뮬레이션
+*
+* 흔한 설정은 특수화한 루프로, 나머지는 엔진의 일반 루프로 수행
+*/
+void sim_run(struct sim *sim)
+{
+        if (!sim_kernel_run(sim))
+                sim_run_until(sim, SCHED_TIME_MAX);
+}
+
+/**
+* sim_simulate - 정책 하나로 job 목록 전체를 시뮬레이션
+* @class: 스케쥴링 정책
+* @head: job 목록
+*
+* 총 turnaround time과 총 response time을 돌려줌
+*/
+struct time_info sim_simulate(const struct sched_class *class,
+                              const struct job_head *head)
+{
+        struct sim sim;
+
+        sim_init(&sim, class, head);
+        sim_run(&sim);
+        sim_destroy(&sim);
+
+        return sim.info;
+}
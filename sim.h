@@ -0,0 +1,223 @@
+﻿#ifndef _SIM_H
+#define _SIM_H
+
+#include "sched.h"
+#include "evq.h"
+
+/*
+ * struct wjob_pool - wait_job을 slab 단위로 할당해 재사용하는 풀
+ * 해제된 wait_job은 rr_list를 free list로 써서 연결된다
+ */
+struct wjob_slab {
+        struct wjob_slab                *next;
+        int                             nr;
+        struct wait_job                 objs[1];
+};
+
+struct wjob_pool {
+        struct wjob_slab                *slabs;
+        struct list_head                free_list;
+        int                             used;
+};
+
+/*
+ * struct prio_array - 우선순위마다 FIFO 큐 하나와 비트맵을 둔 O(1) 대기 목록
+ *
+ * aging은 PRIO_AGING_INTERVAL마다 한 단계씩 오르는 것으로, 큐를 돌며
+ * 고치지 않고 전역 epoch (now / interval)를 기준으로 dequeue 때 처리한다
+ * 큐는 epoch에 대해 원형으로 놓여 있어서 epoch가 하나 오르면
+ * 모든 큐가 한 단계씩 올라간 것이 되고, 0단계를 넘어선 큐만
+ * 0단계 큐 뒤에 이어 붙이면 된다 (list_splice, O(1))
+ * 따라서 결정 하나의 비용은 대기 중인 job 수와 상관없다
+ */
+#define NR_PRIO                 64
+#define PRIO_AGING_INTERVAL     16
+
+struct prio_array {
+        unsigned long long              bitmap;
+        int                             epoch;
+        struct list_head                queue[NR_PRIO];
+};
+
+/* 시간 @now의 epoch, 음수 시간에서도 interval마다 바뀌도록 내림한다 */
+static inline int prio_epoch(const sched_time_t now)
+{
+        return now / PRIO_AGING_INTERVAL - (now % PRIO_AGING_INTERVAL < 0);
+}
+
+/*
+ * 비례 배분 스케쥴링 (sched_share.c)의 상수
+ * stride는 STRIDE1을 티켓 수로 나눈 값, LOTTERY_SEED는 추첨 난수의 시드
+ * 바꾸면 결과가 달라지므로 결과 캐시가 예전 파일을 버린다 (cache.c)
+ */
+#define STRIDE1                 (1ULL << 20)
+#define LOTTERY_SEED            0x9e3779b97f4a7c15ULL
+
+struct sim;
+struct timeline;
+
+/*
+ * struct sched_class - 스케쥴링 정책의 연산 테이블
+ * @enqueue: 도착한 (또는 다시 준비된) job을 대기 목록에 넣음
+ * @pick_next: 다음에 수행할 job을 대기 목록에서 꺼냄, 없으면 NULL
+ * @on_tick: 꺼낸 job을 이번에 얼마나 수행할지 정함
+ * @on_preempt: 수행 시간을 다 쓰고도 끝나지 않은 job을 되돌려 놓음
+ * @on_timer: 정책이 등록한 timer 이벤트 처리 (없으면 NULL)
+ * @on_done: 모든 burst를 마친 job이 풀에 돌아가기 직전에 호출 (없으면 NULL)
+ * @init: 정책 전용 상태를 sim->priv에 준비 (없으면 NULL)
+ * @exit: 정책 전용 상태를 해제 (없으면 NULL)
+ * @fork: 정책 전용 상태를 복사해 @r에 넣고 그 안의 포인터를 고친 뒤
+ *        새 시뮬레이션의 priv에 둠 (정책 전용 상태가 있으면 필요)
+ * @flags: SCHED_PREEMPT_ARRIVAL이면 새 이벤트가 수행 중인 job을 선점
+ *
+ * 시간 진행, 빈 시간 건너뛰기, response/turnaround time 계산은
+ * 엔진이 맡고 정책은 대기 목록만 관리한다
+ */
+struct sched_class {
+        const char                      *name;
+        void (*enqueue)(struct sim *sim, struct wait_job *wjob);
+        struct wait_job *(*pick_next)(struct sim *sim);
+        sched_time_t (*on_tick)(struct sim *sim, struct wait_job *wjob);
+        void (*on_preempt)(struct sim *sim, struct wait_job *wjob);
+        void (*on_timer)(struct sim *sim, struct sim_event *ev);
+        void (*on_done)(struct sim *sim, struct wait_job *wjob);
+        void (*init)(struct sim *sim);
+        void (*exit)(struct sim *sim);
+        void (*fork)(struct sim *dst, const struct sim *src,
+                     struct reloc *r);
+        int                             flags;
+};
+
+#define SCHED_PREEMPT_ARRIVAL   0x1
+
+/*
+ * struct sim - 시뮬레이션 하나의 상태 전체
+ *
+ * 상태가 모두 여기 있으므로 시뮬레이션은 언제든 멈췄다가 이어 갈 수 있다
+ * job 목록은 sim_feed로 조금씩 넣을 수도 있는데, 이때 @horizon은
+ * 그 시간까지 도착하는 job은 모두 들어왔다는 약속이다
+ * 엔진은 @horizon을 넘어서는 시간으로 나아가지 않고 기다린다
+ * @arrived와 @amount_time은 지금 job 목록이 SoA일 때의 열 (job_head 참고)
+ * @curr는 수행을 시작했지만 끝나는 시간으로 아직 나아가지 못한 job
+ * @timeline이 있으면 엔진이 수행한 구간을 모두 기록한다 (timeline.h 참고)
+ * @forked는 sim_fork로 만든 시뮬레이션 표시 (slab을 sim_ctx에 모으지 않음)
+ */
+struct sim {
+        const struct sched_class        *class;
+        const struct job_info           *jobs;
+        const sched_time_t              *arrived;
+        const sched_time_t              *amount_time;
+        int                             job_cnt;
+        const struct burst_pool         *bursts;
+        int                             deadline;
+        int                             trav;
+        int                             nr_arrived;
+        struct job_head                 *feed;
+        int                             feed_head;
+        int                             nr_feed;
+        int                             feed_cap;
+        sched_time_t                    horizon;
+        int                             closed;
+
+        sched_time_t                    now;
+        sched_time_t                    quantum;
+        struct time_info                info;
+        int                             nr_ready;
+        int                             nr_io;
+        struct wait_job                 *curr;
+        sched_time_t                    curr_slice;
+
+        struct rb_root                  rq_tree;
+        struct list_head                rq_list;
+        struct prio_array               rq_prio;
+        unsigned long long              vtime;
+        struct evq                      evq;
+        struct wjob_pool                pool;
+        void                            *priv;
+        struct timeline                 *timeline;
+        int                             forked;
+};
+
+extern void sim_init(struct sim *sim, const struct sched_class *class,
+                     const struct job_head *head);
+extern void sim_open(struct sim *sim, const struct sched_class *class);
+extern void sim_feed(struct sim *sim, const struct job_info *jobs,
+                     const int cnt, const sched_time_t horizon);
+extern void sim_feed_cols(struct sim *sim, const sched_time_t *arrived,
+                          const sched_time_t *amount_time, const int cnt,
+                          const sched_time_t horizon);
+extern void sim_destroy(struct sim *sim);
+extern void sim_ctx_free(void);
+extern int sim_fork(struct sim *dst, const struct sim *src);
+extern int sim_step(struct sim *sim, const int nr);
+extern void sim_run_until(struct sim *sim, const sched_time_t until);
+extern void sim_run(struct sim *sim);
+extern struct time_info sim_simulate(const struct sched_class *class,
+                                     const struct job_head *head);
+
+extern struct wait_job *sim_alloc_wjob(struct sim *sim, const int pos,
+                                       const int idx);
+extern void sim_free_wjob(struct sim *sim, struct wait_job *wjob);
+
+/**
+* sim_add_timer - 정책의 timer 이벤트를 등록
+* @sim: 시뮬레이션
+* @when: 이벤트가 일어날 시간 (현재 시간 이후)
+* @data: on_timer로 넘길 데이터
+*/
+static inline void sim_add_timer(struct sim *sim, const sched_time_t when,
+                                 void *data)
+{
+        evq_push(&sim->evq, when, SIM_EV_TIMER, data);
+}
+
+/**
+* sim_arrival_pending - 아직 도착하지 않은 job이 남았는지 확인
+* @sim: 시뮬레이션
+*/
+static inline int sim_arrival_pending(const struct sim *sim)
+{
+        return sim->trav < sim->job_cnt;
+}
+
+/**
+* sim_feed_pending - 넣은 job 목록 중 아직 다 도착하지 않은 목록 수
+* @sim: sim_open으로 연 시뮬레이션
+*
+* 목록은 넣은 순서대로 도착하므로 나머지 앞선 목록들은 다 지나갔다
+*/
+static inline int sim_feed_pending(const struct sim *sim)
+{
+        return sim->nr_feed + sim_arrival_pending(sim);
+}
+
+/**
+* sim_close - 더 넣을 job이 없음을 알림
+* @sim: sim_open으로 연 시뮬레이션
+*/
+static inline void sim_close(struct sim *sim)
+{
+        sim->closed = 1;
+}
+
+/**
+* sim_finished - 모든 job이 끝났는지 확인
+* @sim: 시뮬레이션
+*/
+static inline int sim_finished(const struct sim *sim)
+{
+        return sim->closed && !sim_arrival_pending(sim) &&
+               !sim->nr_ready && !sim->nr_io;
+}
+
+extern const struct sched_class fcfs_sched_class;
+extern const struct sched_class sjf_sched_class;
+extern const struct sched_class rr_sched_class;
+extern const struct sched_class edf_sched_class;
+extern const struct sched_class prio_sched_class;
+extern const struct sched_class prio_preempt_sched_class;
+extern const struct sched_class stride_sched_class;
+extern const struct sched_class lottery_sched_class;
+extern const struct sched_class fair_sched_class;
+
+#endif
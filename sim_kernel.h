@@ -0,0 +1,77 @@
+﻿/*
+ * 정책 하나에 맞춰 특수화한 시뮬레이션 루프의 틀
+ *
+ * include guard 없이 sim.c에서 아래 매개변수를 정의한 뒤 여러 번
+ * 포함하며, 포함할 때마다 함수 하나가 만들어진다 (C++ template처럼)
+ * 대기 목록 연산을 sched_class의 함수 포인터 대신 직접 부르고 퀀텀이
+ * 상수이므로 on_tick의 min(남은 시간, 퀀텀)과 그 분기가 접힌다
+ *
+ * SIM_KERNEL_FN: 만들 함수의 이름
+ * SIM_KERNEL_PULL: 함께 만들 도착 처리 함수의 이름
+ * SIM_KERNEL_PUSH(sim, wjob): job을 대기 목록에 넣음
+ * SIM_KERNEL_POP(sim): 다음 job을 대기 목록에서 꺼냄, 없으면 NULL
+ * SIM_KERNEL_QUANTUM(sim): 한 번에 수행할 최대 시간, 0이면 끝날 때까지
+ *
+ * I/O burst, timer, 도착 선점, 이어 넣는 job 목록이 없는 시뮬레이션에서만
+ * 쓸 수 있다 (sim_kernel_run 참고). 그 밖의 동작은 sim_advance와 같다
+ */
+
+/* 지금 시간까지 도착한 job을 모두 대기 목록에 넣음 (sim_pull_events) */
+static inline void SIM_KERNEL_PULL(struct sim *sim)
+{
+        int end;
+
+        if (!sim_arrival_pending(sim) ||
+            sim_arrived_at(sim, sim->trav) > sim->now)
+                return;
+
+        end = sim->trav + sim_arrival_window(sim, sim->now);
+        sim->nr_ready += end - sim->trav;
+        for (int pos = sim->trav; pos < end; pos++)
+                SIM_KERNEL_PUSH(sim, sim_alloc_wjob(sim, pos,
+                                                    sim->nr_arrived++));
+        sim->trav = end;
+}
+
+static void SIM_KERNEL_FN(struct sim *sim)
+{
+        for (;;) {
+                struct wait_job *wjob;
+                sched_time_t slice;
+
+                SIM_KERNEL_PULL(sim);
+                wjob = SIM_KERNEL_POP(sim);
+                if (!wjob) {
+                        if (!sim_arrival_pending(sim))
+                                break;
+                        sim->now = sim_arrived_at(sim, sim->trav);
+                        continue;
+                }
+
+                slice = wjob->burst - wjob->run_time;
+                if (SIM_KERNEL_QUANTUM(sim) && slice > SIM_KERNEL_QUANTUM(sim))
+                        slice = SIM_KERNEL_QUANTUM(sim);
+                if (first_sched(wjob))
+                        sim->info.resp_time += sim->now - wjob->arrived;
+
+                sim->now += slice;
+                wjob->run_time += slice;
+                SIM_KERNEL_PULL(sim);
+
+                if (job_done(wjob)) {
+                        sim->info.tard_time += sim->now - wjob->arrived;
+                        if (sim->deadline)
+                                sim_check_deadline(sim, wjob);
+                        sim->nr_ready--;
+                        sim_free_wjob(sim, wjob);
+                } else {
+                        SIM_KERNEL_PUSH(sim, wjob);
+                }
+        }
+}
+
+#undef SIM_KERNEL_FN
+#undef SIM_KERNEL_PULL
+#undef SIM_KERNEL_PUSH
+#undef SIM_KERNEL_POP
+#undef SIM_KERNEL_QUANTUM
@@ -0,0 +1,327 @@
+﻿#include <stdlib.h>
+#include "timeline.h"
+
+/* 구간 하나는 가변 길이 정수 네 개, 가장 길면 5 + 5 + 5 + 10바이트 */
+#define TL_SEG_MAX      25
+#define TL_BLOCK_MAX    (NR_TL_BLOCK * TL_SEG_MAX)
+
+static inline unsigned char *tl_put(unsigned char *p, unsigned long long v)
+{
+        while (v >= 0x80) {
+                *p++ = (unsigned char)(v | 0x80);
+                v >>= 7;
+        }
+        *p++ = (unsigned char)v;
+        return p;
+}
+
+static inline const unsigned char *tl_get(const unsigned char *p,
+                                          unsigned long long *v)
+{
+        unsigned long long x = 0;
+        int shift = 0;
+
+        while (*p & 0x80) {
+                x |= (unsigned long long)(*p++ & 0x7f) << shift;
+                shift += 7;
+        }
+        *v = x | (unsigned long long)*p++ << shift;
+        return p;
+}
+
+/* job 인덱스의 차이는 음수일 수 있으므로 zigzag로 바꿔 작은 수로 만든다 */
+static inline unsigned int tl_zigzag(const int v)
+{
+        return ((unsigned int)v << 1) ^ (unsigned int)(v >> 31);
+}
+
+static inline int tl_unzigzag(const unsigned int v)
+{
+        return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+/**
+* timeline_init - 빈 timeline을 만듦
+* @tl: timeline
+*/
+void timeline_init(struct timeline *tl)
+{
+        tl->pages = NULL;
+        tl->nr_pages = 0;
+        tl->page_cap = 0;
+        tl->page_used = TL_PAGE_SIZE;
+        tl->blocks = NULL;
+        tl->nr_blocks = 0;
+        tl->block_cap = 0;
+        tl->nr_segs = 0;
+        tl->job_last = NULL;
+        tl->job_cap = 0;
+        tl->has_pending = 0;
+        tl->enc_end = 0;
+        tl->enc_idx = 0;
+}
+
+/**
+* timeline_free - timeline의 메모리를 해제
+* @tl: timeline
+*/
+void timeline_free(struct timeline *tl)
+{
+        for (int i = 0; i < tl->nr_pages; i++)
+                free(tl->pages[i]);
+        free(tl->pages);
+        free(tl->blocks);
+        free(tl->job_last);
+        timeline_init(tl);
+}
+
+/**
+* tl_new_block - 새 block을 열고 그 첫 구간을 쓸 자리를 정함
+* @tl: timeline
+* @start: block 첫 구간의 시작 시간
+*
+* block 하나는 page 하나 안에 들어가도록 page에 남은 자리가
+* TL_BLOCK_MAX보다 작으면 새 page로 넘어간다
+*/
+static void tl_new_block(struct timeline *tl, const sched_time_t start)
+{
+        struct tl_block *block;
+
+        if (tl->page_used + TL_BLOCK_MAX > TL_PAGE_SIZE) {
+                if (tl->nr_pages == tl->page_cap) {
+                        tl->page_cap = tl->page_cap ? 2 * tl->page_cap : 16;
+                        tl->pages = realloc(tl->pages, tl->page_cap *
+                                            sizeof(unsigned char *));
+                }
+                tl->pages[tl->nr_pages++] = malloc(TL_PAGE_SIZE);
+                tl->page_used = 0;
+        }
+        if (tl->nr_blocks == tl->block_cap) {
+                tl->block_cap = tl->block_cap ? 2 * tl->block_cap : 1024;
+                tl->blocks = realloc(tl->blocks, tl->block_cap *
+                                     sizeof(struct tl_block));
+        }
+
+        block = tl->blocks + tl->nr_blocks++;
+        block->off = ((long long)(tl->nr_pages - 1) << TL_PAGE_BITS) |
+                     tl->page_used;
+        block->start = start;
+        tl->enc_end = start;
+        tl->enc_idx = 0;
+}
+
+/* 구간 하나를 압축해 마지막 block 뒤에 붙임 */
+static void tl_encode(struct timeline *tl, const struct tl_seg *seg)
+{
+        unsigned char *p, *q;
+
+        if (tl->nr_segs % NR_TL_BLOCK == 0)
+                tl_new_block(tl, seg->start);
+
+        p = q = tl->pages[tl->nr_pages - 1] + tl->page_used;
+        p = tl_put(p, (unsigned int)(seg->start - tl->enc_end));
+        p = tl_put(p, (unsigned int)seg->len);
+        p = tl_put(p, tl_zigzag(seg->idx - tl->enc_idx));
+        p = tl_put(p, (unsigned long long)seg->back);
+        tl->page_used += (int)(p - q);
+        tl->enc_end = seg->start + seg->len;
+        tl->enc_idx = seg->idx;
+        tl->nr_segs++;
+}
+
+/**
+* timeline_add - 수행 구간 하나를 기록
+* @tl: timeline
+* @idx: 수행한 job의 인덱스
+* @start: 시작 시간 (앞 구간이 끝난 시간 이후)
+* @len: 수행한 시간
+*
+* 길이가 0인 구간은 버리고, 앞 구간에 바로 이어지는 같은 job의
+* 구간은 앞 구간을 늘린다
+*/
+void timeline_add(struct timeline *tl, const int idx,
+                  const sched_time_t start, const sched_time_t len)
+{
+        struct tl_seg *p = &tl->pending;
+        long long nr;
+
+        if (!len)
+                return;
+        if (tl->has_pending && p->idx == idx && p->start + p->len == start) {
+                p->len += len;
+                return;
+        }
+
+        if (tl->has_pending)
+                tl_encode(tl, p);
+        if (idx >= tl->job_cap) {
+                int cap = max(idx + 1, 2 * tl->job_cap);
+
+                tl->job_last = realloc(tl->job_last, cap * sizeof(long long));
+                for (int i = tl->job_cap; i < cap; i++)
+                        tl->job_last[i] = 0;
+                tl->job_cap = cap;
+        }
+
+        nr = tl->nr_segs;
+        p->idx = idx;
+        p->start = start;
+        p->len = len;
+        p->back = tl->job_last[idx] ? nr - (tl->job_last[idx] - 1) : 0;
+        tl->job_last[idx] = nr + 1;
+        tl->has_pending = 1;
+}
+
+/*
+ * struct tl_cursor - block 하나를 앞에서부터 푸는 위치
+ */
+struct tl_cursor {
+        const unsigned char             *p;
+        sched_time_t                    end;
+        int                             idx;
+};
+
+static void tl_cursor_init(struct tl_cursor *c, const struct timeline *tl,
+                           const long long b)
+{
+        const struct tl_block *block = tl->blocks + b;
+
+        c->p = tl->pages[block->off >> TL_PAGE_BITS] +
+               (block->off & (TL_PAGE_SIZE - 1));
+        c->end = block->start;
+        c->idx = 0;
+}
+
+static void tl_cursor_next(struct tl_cursor *c, struct tl_seg *seg)
+{
+        unsigned long long v;
+
+        c->p = tl_get(c->p, &v);
+        seg->start = c->end + (sched_time_t)v;
+        c->p = tl_get(c->p, &v);
+        seg->len = (sched_time_t)v;
+        c->p = tl_get(c->p, &v);
+        seg->idx = c->idx + tl_unzigzag((unsigned int)v);
+        c->p = tl_get(c->p, &v);
+        seg->back = (long long)v;
+        c->end = seg->start + seg->len;
+        c->idx = seg->idx;
+}
+
+/**
+* tl_seg_at - @nr번째 구간을 풀어서 구함
+* @tl: timeline
+* @nr: 구간의 번호 (timeline_nr보다 작아야 함)
+* @seg: 구간을 기록
+*
+* 구간이 속한 block을 처음부터 풀므로 NR_TL_BLOCK번 이내로 끝난다
+*/
+static void tl_seg_at(const struct timeline *tl, const long long nr,
+                      struct tl_seg *seg)
+{
+        struct tl_cursor c;
+
+        if (nr == tl->nr_segs) {
+                *seg = tl->pending;
+                return;
+        }
+
+        tl_cursor_init(&c, tl, nr / NR_TL_BLOCK);
+        for (long long i = nr / NR_TL_BLOCK * NR_TL_BLOCK; i <= nr; i++)
+                tl_cursor_next(&c, seg);
+}
+
+/**
+* timeline_at - 시간 @t에 수행 중이던 구간을 찾음
+* @tl: timeline
+* @t: 시간
+* @seg: 찾은 구간을 기록
+*
+* CPU가 쉬고 있었으면 0을 돌려줌
+* 시작 시간이 @t 이하인 마지막 block을 이분 탐색으로 찾고 그 block만 푼다
+*/
+int timeline_at(const struct timeline *tl, const sched_time_t t,
+                struct tl_seg *seg)
+{
+        long long lo = 0, hi = tl->nr_blocks;
+        struct tl_cursor c;
+        struct tl_seg cur;
+        int found = 0;
+
+        if (tl->has_pending && tl->pending.start <= t) {
+                *seg = tl->pending;
+                return t < seg->start + seg->len;
+        }
+
+        /* blocks[lo - 1]이 시작 시간이 t 이하인 마지막 block */
+        while (lo < hi) {
+                long long mid = lo + (hi - lo) / 2;
+
+                if (tl->blocks[mid].start <= t)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        if (!lo)
+                return 0;
+
+        tl_cursor_init(&c, tl, lo - 1);
+        for (long long i = (lo - 1) * NR_TL_BLOCK;
+             i < min(lo * NR_TL_BLOCK, tl->nr_segs); i++) {
+                tl_cursor_next(&c, &cur);
+                if (cur.start > t)
+                        break;
+                *seg = cur;
+                found = 1;
+        }
+
+        return found && t < seg->start + seg->len;
+}
+
+/**
+* timeline_job - job 하나의 수행 기록을 구함
+* @tl: timeline
+* @idx: job의 인덱스
+* @segs: 구간들을 시간 순서로 기록
+* @max: @segs에 담을 수 있는 구간 수
+*
+* 기록한 구간 수를 돌려주며, @max보다 많으면 가장 나중의 @max개만 담는다
+* 마지막 구간에서 같은 job의 앞 구간으로 거슬러 올라가므로
+* 구간 하나에 block 하나를 푸는 만큼 든다
+*/
+long long timeline_job(const struct timeline *tl, const int idx,
+                       struct tl_seg *segs, const long long max)
+{
+        long long nr, cnt = 0;
+
+        if (idx < 0 || idx >= tl->job_cap || !tl->job_last[idx])
+                return 0;
+
+        for (nr = tl->job_last[idx] - 1; cnt < max; cnt++) {
+                tl_seg_at(tl, nr, segs + cnt);
+                if (!segs[cnt].back) {
+                        cnt++;
+                        break;
+                }
+                nr -= segs[cnt].back;
+        }
+
+        for (long long i = 0; i < cnt / 2; i++) {
+                struct tl_seg tmp = segs[i];
+
+                segs[i] = segs[cnt - 1 - i];
+                segs[cnt - 1 - i] = tmp;
+        }
+        return cnt;
+}
+
+/**
+* timeline_bytes - timeline이 쓰는 메모리의 크기를 구함
+* @tl: timeline
+*/
+size_t timeline_bytes(const struct timeline *tl)
+{
+        return (size_t)tl->nr_pages * TL_PAGE_SIZE +
+               (size_t)tl->block_cap * sizeof(struct tl_block) +
+               (size_t)tl->job_cap * sizeof(long long);
+}
@@ -0,0 +1,78 @@
+﻿#ifndef _TIMELINE_H
+#define _TIMELINE_H
+
+#include <stddef.h>
+#include "sched.h"
+
+/*
+ * 시뮬레이션이 실제로 수행한 스케쥴 (timeline)
+ *
+ * 수행 구간 (job 인덱스, 시작 시간, 길이)을 시간 순서대로 받아
+ * 같은 job이 이어서 수행된 구간은 하나로 합친 뒤 가변 길이 정수로
+ * 압축해 쌓는다. 구간 하나는 보통 4~6바이트다
+ * 구간은 NR_TL_BLOCK개씩 block으로 묶고, block마다 첫 구간의 시작 시간과
+ * 위치를 따로 두어 "t에 수행 중이던 job"은 block을 이분 탐색한 뒤
+ * block 하나만 풀어서 찾는다
+ * 구간마다 같은 job의 앞 구간까지의 거리를 함께 두고 job마다 마지막
+ * 구간을 기억하므로 "job i의 수행 기록"은 그 사슬을 거꾸로 따라간다
+ * 구간은 시간 순서로만 들어오므로 block 목록은 정렬된 배열로 충분하다
+ */
+#define NR_TL_BLOCK             64
+#define TL_PAGE_BITS            20
+#define TL_PAGE_SIZE            (1 << TL_PAGE_BITS)
+
+struct tl_seg {
+        int                             idx;
+        sched_time_t                    start;
+        sched_time_t                    len;
+        long long                       back;
+};
+
+struct tl_block {
+        long long                       off;
+        sched_time_t                    start;
+};
+
+/*
+ * @pages: 압축한 구간을 담는 TL_PAGE_SIZE 바이트 page들
+ * @job_last: job마다 마지막 구간의 번호 + 1 (0이면 수행한 적 없음)
+ * @pending: 아직 압축하지 않은 마지막 구간 (다음 구간과 합칠 수 있음)
+ * @enc_end, @enc_idx: 마지막으로 압축한 구간의 끝 시간과 job 인덱스
+ */
+struct timeline {
+        unsigned char                   **pages;
+        int                             nr_pages;
+        int                             page_cap;
+        int                             page_used;
+        struct tl_block                 *blocks;
+        long long                       nr_blocks;
+        long long                       block_cap;
+        long long                       nr_segs;
+        long long                       *job_last;
+        int                             job_cap;
+        struct tl_seg                   pending;
+        int                             has_pending;
+        sched_time_t                    enc_end;
+        int                             enc_idx;
+};
+
+extern void timeline_init(struct timeline *tl);
+extern void timeline_free(struct timeline *tl);
+extern void timeline_add(struct timeline *tl, const int idx,
+                         const sched_time_t start, const sched_time_t len);
+extern int timeline_at(const struct timeline *tl, const sched_time_t t,
+                       struct tl_seg *seg);
+extern long long timeline_job(const struct timeline *tl, const int idx,
+                              struct tl_seg *segs, const long long max);
+extern size_t timeline_bytes(const struct timeline *tl);
+
+/**
+* timeline_nr - 기록한 구간 수를 구함
+* @tl: timeline
+*/
+static inline long long timeline_nr(const struct timeline *tl)
+{
+        return tl->nr_segs + tl->has_pending;
+}
+
+#endif